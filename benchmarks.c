@@ -0,0 +1,172 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+// Micro-benchmarks of the library's hot paths. The release build compiles this and vector.c at each
+// checking level to measure the cost of argument checks, including those in the accessors and
+// cursors inlined here.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "vector.h"
+#include "vector_cursor.h"
+#include "vector_inline.h"
+
+typedef uint64_t (*benchmark_func_t)(size_t);
+
+typedef struct benchmark_info_t {
+    benchmark_func_t func;
+    const char *name;
+} benchmark_info_t;
+
+#define BENCHMARK_INFO_CREATE(func) { func, #func }
+
+static const size_t ELEMENTS = 1 << 20;
+static const size_t ROUNDS = 64;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t benchmark_get(const size_t rounds) {
+    vector_t *vector = vector_create_with_size(sizeof(uint64_t), ELEMENTS);
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        *(uint64_t *)vector_get(vector, i) = i;
+    }
+    uint64_t sum = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < ELEMENTS; ++i) {
+            sum += *(const uint64_t *)vector_get(vector, i);
+        }
+    }
+    vector_destroy(vector);
+    return sum;
+}
+
+static uint64_t benchmark_inline_get(const size_t rounds) {
+    vector_t *vector = vector_create_with_size(sizeof(uint64_t), ELEMENTS);
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        *(uint64_t *)vector_inline_get(vector, i) = i;
+    }
+    uint64_t sum = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < vector_inline_size(vector); ++i) {
+            sum += *(const uint64_t *)vector_inline_get(vector, i);
+        }
+    }
+    vector_destroy(vector);
+    return sum;
+}
+
+static uint64_t benchmark_cursor(const size_t rounds) {
+    vector_t *vector = vector_create_with_size(sizeof(uint64_t), ELEMENTS);
+    VECTOR_FOREACH(vector, uint64_t, value) {
+        *value = (uint64_t)(value - (uint64_t *)vector_data(vector));
+    }
+    uint64_t sum = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (vector_cursor_t cursor = vector_begin(vector); !vector_end(&cursor); vector_next(&cursor)) {
+            sum += *(const uint64_t *)vector_cursor_get(&cursor);
+        }
+    }
+    vector_destroy(vector);
+    return sum;
+}
+
+static uint64_t benchmark_foreach(const size_t rounds) {
+    vector_t *vector = vector_create_with_size(sizeof(uint64_t), ELEMENTS);
+    VECTOR_FOREACH(vector, uint64_t, value) {
+        *value = (uint64_t)(value - (uint64_t *)vector_data(vector));
+    }
+    uint64_t sum = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        VECTOR_FOREACH(vector, const uint64_t, value) {
+            sum += *value;
+        }
+    }
+    vector_destroy(vector);
+    return sum;
+}
+
+static uint64_t benchmark_set(const size_t rounds) {
+    vector_t *vector = vector_create_with_size(sizeof(uint64_t), ELEMENTS);
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < ELEMENTS; ++i) {
+            const uint64_t value = i + round;
+            vector_set(vector, i, &value);
+        }
+    }
+    const uint64_t result = *(const uint64_t *)vector_back(vector);
+    vector_destroy(vector);
+    return result;
+}
+
+static uint64_t benchmark_inline_push_back(const size_t rounds) {
+    vector_t *vector = vector_create(sizeof(uint64_t));
+    vector_reserve(vector, ELEMENTS);
+    uint64_t result = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        vector_clear(vector);
+        for (uint64_t i = 0; i < ELEMENTS; ++i) {
+            vector_inline_push_back(vector, &i);
+        }
+        result += vector_size(vector);
+    }
+    vector_destroy(vector);
+    return result;
+}
+
+static uint64_t benchmark_push_back(const size_t rounds) {
+    vector_t *vector = vector_create(sizeof(uint64_t));
+    vector_reserve(vector, ELEMENTS);
+    uint64_t result = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+        vector_clear(vector);
+        for (uint64_t i = 0; i < ELEMENTS; ++i) {
+            vector_push_back(vector, &i);
+        }
+        result += vector_size(vector);
+    }
+    vector_destroy(vector);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    const benchmark_info_t benchmarks[] = {
+        BENCHMARK_INFO_CREATE(benchmark_get),
+        BENCHMARK_INFO_CREATE(benchmark_inline_get),
+        BENCHMARK_INFO_CREATE(benchmark_cursor),
+        BENCHMARK_INFO_CREATE(benchmark_foreach),
+        BENCHMARK_INFO_CREATE(benchmark_set),
+        BENCHMARK_INFO_CREATE(benchmark_push_back),
+        BENCHMARK_INFO_CREATE(benchmark_inline_push_back),
+    };
+
+    const size_t num_benchmarks = sizeof(benchmarks) / sizeof(benchmark_info_t);
+    for (size_t i = 0; i < num_benchmarks; ++i) {
+        const double start = now();
+        const uint64_t result = benchmarks[i].func(ROUNDS);
+        const double elapsed = now() - start;
+        printf("%-28s %8.3f ns/op (%llu)\n", benchmarks[i].name, elapsed * 1e9 / (double)(ELEMENTS * ROUNDS),
+               (unsigned long long)result);
+    }
+    return 0;
+}
@@ -14,12 +14,39 @@
  limitations under the License.
  */
 
+#define _DEFAULT_SOURCE
+
 #include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#   include <sys/mman.h>
+#endif
 
 #include "vector.h"
+#include "vector_bit.h"
+#include "vector_cache.h"
+#include "vector_check.h"
+#include "vector_compressed.h"
 #include "vector_convenience_accessors.h"
+#include "vector_cursor.h"
+#include "vector_external.h"
+#include "vector_gap.h"
+#include "vector_inline.h"
+#include "vector_memory.h"
+#include "vector_mpsc.h"
+#include "vector_numa.h"
+#include "vector_parallel.h"
+#include "vector_pool.h"
+#include "vector_rcu.h"
+#include "vector_search.h"
+#include "vector_soa.h"
 #include "vector_system.h"
+#include "vector_trace.h"
 
 typedef void (*test_func_t)(void);
 
@@ -68,6 +95,51 @@ static int vfprintf_func(FILE * restrict stream, const char * restrict format, v
     return 0;
 }
 
+// An element that owns a heap allocation, for testing element functions.
+typedef struct owner_t {
+    int *value;
+} owner_t;
+
+static int OWNER_COPY_COUNT = 0;
+static int OWNER_MOVE_COUNT = 0;
+static int OWNER_DESTROY_COUNT = 0;
+
+static owner_t owner_create(int value) {
+    owner_t owner = { malloc(sizeof(int)) };
+    *owner.value = value;
+    return owner;
+}
+
+static void owner_copy(void *dst, const void *src) {
+    ++OWNER_COPY_COUNT;
+    *(owner_t *)dst = owner_create(*((const owner_t *)src)->value);
+}
+
+static void owner_move(void *dst, void *src) {
+    ++OWNER_MOVE_COUNT;
+    *(owner_t *)dst = *(owner_t *)src;
+    ((owner_t *)src)->value = NULL;
+}
+
+static void owner_destroy(void *element) {
+    ++OWNER_DESTROY_COUNT;
+    free(((owner_t *)element)->value);
+}
+
+static const vector_element_funcs_t OWNER_FUNCS = { owner_copy, owner_move, owner_destroy };
+
+static vector_t *owner_vector_create(int count) {
+    vector_t *vector = vector_create(sizeof(owner_t));
+    vector_set_element_funcs(vector, &OWNER_FUNCS);
+    for (int i = 0; i < count; ++i) {
+        *(owner_t *)vector_emplace_back(vector) = owner_create(i);
+    }
+    OWNER_COPY_COUNT = 0;
+    OWNER_MOVE_COUNT = 0;
+    OWNER_DESTROY_COUNT = 0;
+    return vector;
+}
+
 static void test_create() {
     vector_t *vector = vector_create(3);
 
@@ -182,6 +254,78 @@ static void test_resize_up() {
     vector_destroy(vector);
 }
 
+static void test_adopt() {
+    int *data = malloc(10 * sizeof(int));
+    for (int i = 0; i < 5; ++i) {
+        data[i] = i;
+    }
+    vector_t *vector = vector_adopt(sizeof(int), data, 5, 10);
+
+    assert_invariants(vector);
+    assert(vector_data(vector) == data);
+    assert(vector_size(vector) == 5);
+    assert(vector_capacity(vector) == 10);
+    assert(VECTOR_GET(vector, 4, int) == 4);
+
+    VECTOR_PUSH_BACK(vector, 5);
+    assert(vector_data(vector) == data);
+    vector_resize(vector, 100);  // Grows the adopted buffer.
+    assert(VECTOR_GET(vector, 5, int) == 5);
+    vector_destroy(vector);
+
+    vector = vector_adopt(sizeof(int), NULL, 0, 0);
+    assert(vector_empty(vector));
+    VECTOR_PUSH_BACK(vector, 42);
+    assert(VECTOR_GET(vector, 0, int) == 42);
+    vector_destroy(vector);
+}
+
+static void test_release() {
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    const void *expected = vector_data(vector);
+
+    size_t size = 0;
+    int *data = vector_release(vector, &size);
+    assert(data == expected);
+    assert(size == 3);
+    assert(data[0] == 42 && data[2] == 7);
+
+    // The buffer can be adopted again without copying.
+    vector = vector_adopt(sizeof(int), data, size, size);
+    assert(vector_data(vector) == data);
+    assert(vector_release(vector, NULL) == data);
+    free(data);
+
+    vector = vector_create(sizeof(int));
+    assert(vector_release(vector, &size) == NULL);
+    assert(size == 0);
+}
+
+static void test_inline_accessors() {
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+
+    assert(vector_inline_size(vector) == vector_size(vector));
+    assert(vector_inline_data(vector) == vector_data(vector));
+    assert(vector_inline_front(vector) == vector_front(vector));
+    assert(vector_inline_back(vector) == vector_back(vector));
+    for (size_t i = 0; i < 3; ++i) {
+        assert(vector_inline_get(vector, i) == vector_get(vector, i));
+    }
+
+    // Appends both within the capacity and with growth.
+    for (int i = 0; i < 100; ++i) {
+        vector_inline_push_back(vector, &i);
+    }
+    assert_invariants(vector);
+    assert(vector_size(vector) == 103);
+    assert(*(int *)vector_inline_get(vector, 2) == 7);
+    assert(*(int *)vector_inline_back(vector) == 99);
+
+    vector_destroy(vector);
+}
+
 static void test_resize_down() {
     const int values[] = { 42, 23, 7 };
     vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
@@ -196,6 +340,71 @@ static void test_resize_down() {
     vector_destroy(vector);
 }
 
+static void test_resize_default() {
+    vector_t *vector = vector_create(sizeof(int));
+    const int fill = 42;
+    vector_resize_default(vector, 5, &fill);
+
+    assert_invariants(vector);
+    assert(vector_size(vector) == 5);
+    assert(vector_capacity(vector) == 5);
+    for (int i = 0; i < 5; ++i) {
+        assert(VECTOR_GET(vector, i, int) == 42);
+    }
+
+    const int other_fill = 7;
+    vector_resize_default(vector, 2, NULL);
+    vector_resize_default(vector, 4, &other_fill);
+    assert(vector_size(vector) == 4);
+    assert(VECTOR_GET(vector, 1, int) == 42);
+    assert(VECTOR_GET(vector, 2, int) == 7);
+    assert(VECTOR_GET(vector, 3, int) == 7);
+
+    vector_destroy(vector);
+}
+
+static void test_reserve_additional() {
+    vector_t *vector = vector_create(sizeof(int));
+    VECTOR_PUSH_BACK(vector, 1);
+    VECTOR_PUSH_BACK(vector, 2);
+    VECTOR_PUSH_BACK(vector, 3);
+
+    // The capacity is exact rather than rounded up by the expansion factor.
+    vector_reserve_additional(vector, 10);
+    assert_invariants(vector);
+    assert(vector_capacity(vector) == 13);
+
+    void *data = vector_data(vector);
+    for (int i = 0; i < 10; ++i) {
+        VECTOR_PUSH_BACK(vector, i);
+    }
+    assert(vector_data(vector) == data);
+    assert(vector_capacity(vector) == 13);
+
+    vector_reserve_additional(vector, 0);
+    assert(vector_capacity(vector) == 13);
+
+    vector_destroy(vector);
+}
+
+static void test_shrink_to() {
+    vector_t *vector = vector_create_with_size(sizeof(int), 10);
+    vector_reserve(vector, 100);
+
+    vector_shrink_to(vector, 50);
+    assert_invariants(vector);
+    assert(vector_capacity(vector) == 50);
+
+    vector_shrink_to(vector, 80);  // Never grows.
+    assert(vector_capacity(vector) == 50);
+
+    vector_shrink_to(vector, 0);  // Never drops elements.
+    assert(vector_capacity(vector) == 10);
+    assert(vector_size(vector) == 10);
+
+    vector_destroy(vector);
+}
+
 static void test_size_to_fit() {
     vector_t *vector = vector_create(sizeof(int));
     vector_reserve(vector, 10);
@@ -354,6 +563,35 @@ static void test_convenience_push_back() {
     vector_destroy(vector);
 }
 
+static void test_emplace_back() {
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    int *slot = vector_emplace_back(vector);
+    *slot = 77;
+
+    assert_invariants(vector);
+    assert(vector_size(vector) == 4);
+    assert(*(int *)vector_get(vector, 3) == 77);
+
+    vector_destroy(vector);
+}
+
+static void test_emplace_back_n() {
+    vector_t *vector = vector_create(sizeof(int));
+    int *slots = vector_emplace_back_n(vector, 100);
+    for (int i = 0; i < 100; ++i) {
+        slots[i] = i;
+    }
+
+    assert_invariants(vector);
+    assert(vector_size(vector) == 100);
+    for (int i = 0; i < 100; ++i) {
+        assert(*(int *)vector_get(vector, i) == i);
+    }
+
+    vector_destroy(vector);
+}
+
 static void test_pop_back() {
     const int values[] = { 42, 23, 7 };
     vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
@@ -404,6 +642,39 @@ static void test_insert() {
     vector_destroy(vector);
 }
 
+static void test_insert_middle() {
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    vector_size_to_fit(vector);
+    int value = 77;
+    vector_insert(vector, 2, &value);
+
+    assert_invariants(vector);
+    assert(vector_size(vector) == 4);
+    assert(*(int *)vector_get(vector, 0) == 42);
+    assert(*(int *)vector_get(vector, 1) == 23);
+    assert(*(int *)vector_get(vector, 2) == 77);
+    assert(*(int *)vector_get(vector, 3) == 7);
+
+    vector_destroy(vector);
+}
+
+static void test_emplace() {
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    int *slot = vector_emplace(vector, 1);
+    *slot = 77;
+
+    assert_invariants(vector);
+    assert(vector_size(vector) == 4);
+    assert(*(int *)vector_get(vector, 0) == 42);
+    assert(*(int *)vector_get(vector, 1) == 77);
+    assert(*(int *)vector_get(vector, 2) == 23);
+    assert(*(int *)vector_get(vector, 3) == 7);
+
+    vector_destroy(vector);
+}
+
 static void test_convenience_insert() {
     const int values[] = { 42, 23, 7 };
     vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
@@ -512,6 +783,963 @@ static void test_capacity() {
     vector_destroy(vector);
 }
 
+// Cursors
+
+static void test_cursor() {
+    vector_t *vector = vector_create(sizeof(int));
+    vector_cursor_t cursor = vector_begin(vector);
+    assert(vector_end(&cursor));
+
+    for (int i = 0; i < 10; ++i) {
+        VECTOR_PUSH_BACK(vector, i);
+    }
+    int expected = 0;
+    for (cursor = vector_begin(vector); !vector_end(&cursor); vector_next(&cursor)) {
+        assert(*(int *)vector_cursor_get(&cursor) == expected++);
+    }
+    assert(expected == 10);
+
+    int sum = 0;
+    VECTOR_FOREACH(vector, int, value) {
+        sum += *value;
+    }
+    assert(sum == 45);
+
+    vector_destroy(vector);
+}
+
+static void test_cursor_strided() {
+    vector_t *vector = vector_create(sizeof(double));
+    for (int i = 0; i < 10; ++i) {
+        VECTOR_PUSH_BACK(vector, (double)i);
+    }
+
+    const size_t firsts[] = { 0, 1, 2, 9, 10 };
+    const size_t strides[] = { 1, 2, 3, 4, 9, 10, 100 };
+    for (size_t f = 0; f < sizeof(firsts) / sizeof(size_t); ++f) {
+        for (size_t s = 0; s < sizeof(strides) / sizeof(size_t); ++s) {
+            vector_cursor_t cursor = vector_begin_strided(vector, firsts[f], strides[s]);
+            vector_cursor_set_prefetch(&cursor, 2);
+            size_t expected = firsts[f];
+            for (; !vector_end(&cursor); vector_next(&cursor)) {
+                assert(*(double *)vector_cursor_get(&cursor) == (double)expected);
+                expected += strides[s];
+            }
+            assert(expected >= 10);
+            assert(expected < 10 + strides[s] || firsts[f] == 10);
+        }
+    }
+
+    vector_destroy(vector);
+}
+
+// Element functions
+
+static void test_element_funcs_destroy() {
+    vector_t *vector = owner_vector_create(10);
+
+    vector_pop_back(vector);
+    assert(OWNER_DESTROY_COUNT == 1);
+    vector_erase(vector, 0);
+    assert(OWNER_DESTROY_COUNT == 2);
+    assert(*((owner_t *)vector_get(vector, 0))->value == 1);
+    vector_resize(vector, 5);
+    assert(OWNER_DESTROY_COUNT == 5);
+    vector_clear(vector);
+    assert(OWNER_DESTROY_COUNT == 10);
+
+    vector_resize(vector, 0);
+    owner_t owner = owner_create(42);
+    vector_push_back(vector, &owner);
+    assert(OWNER_COPY_COUNT == 1);
+    vector_destroy(vector);
+    assert(OWNER_DESTROY_COUNT == 11);
+    free(owner.value);
+}
+
+static void test_element_funcs_copy() {
+    vector_t *first = owner_vector_create(3);
+    vector_t *second = vector_create_with_vector(first);
+
+    assert(OWNER_COPY_COUNT == 3);
+    assert(vector_element_funcs(second)->destroy == owner_destroy);
+    for (int i = 0; i < 3; ++i) {
+        owner_t *a = vector_get(first, i);
+        owner_t *b = vector_get(second, i);
+        assert(a->value != b->value && *a->value == *b->value);
+    }
+
+    owner_t owner = owner_create(42);
+    vector_set(second, 1, &owner);
+    assert(OWNER_DESTROY_COUNT == 1);
+    assert(*((owner_t *)vector_get(second, 1))->value == 42);
+    VECTOR_PUSH_BACK(second, owner);
+    assert(OWNER_COPY_COUNT == 5);
+    assert(((owner_t *)vector_back(second))->value != owner.value);
+    free(owner.value);
+
+    vector_destroy(first);
+    vector_destroy(second);
+}
+
+static void test_element_funcs_move() {
+    vector_t *vector = owner_vector_create(10);
+    vector_size_to_fit(vector);
+    assert(OWNER_MOVE_COUNT == 10);
+
+    vector_reserve(vector, 100);
+    assert(OWNER_MOVE_COUNT == 20);
+
+    owner_t owner = owner_create(42);
+    vector_insert(vector, 3, &owner);
+    assert(OWNER_MOVE_COUNT == 27);
+    vector_erase(vector, 0);
+    assert(OWNER_MOVE_COUNT == 37);
+    for (int i = 0; i < 10; ++i) {
+        const int expected = i < 2 ? i + 1 : (i == 2 ? 42 : i);
+        assert(*((owner_t *)vector_get(vector, i))->value == expected);
+    }
+    free(owner.value);
+
+    vector_destroy(vector);
+    assert(OWNER_DESTROY_COUNT == 11);
+}
+
+// Gap buffers
+
+static void test_gap_insert_at_cursor() {
+    vector_gap_t *gap = vector_gap_create(sizeof(int));
+    for (int i = 0; i < 10; ++i) {
+        vector_gap_insert(gap, vector_gap_size(gap), &i);
+    }
+    // Type "abc" in the middle, then go back and insert before it.
+    for (int i = 0; i < 3; ++i) {
+        int value = 100 + i;
+        vector_gap_insert(gap, 5 + i, &value);
+    }
+    int value = 99;
+    vector_gap_insert(gap, 5, &value);
+
+    assert(vector_gap_size(gap) == 14);
+    assert(vector_gap_cursor(gap) == 6);
+    const int expected[] = { 0, 1, 2, 3, 4, 99, 100, 101, 102, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 14; ++i) {
+        assert(*(int *)vector_gap_get(gap, i) == expected[i]);
+    }
+
+    vector_gap_destroy(gap);
+}
+
+static void test_gap_erase() {
+    const int values[] = { 42, 23, 7, 3 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 4, values);
+    vector_gap_t *gap = vector_gap_create_with_vector(vector);
+    vector_gap_erase(gap, 1);
+    vector_gap_erase(gap, 1);
+
+    assert(vector_gap_size(gap) == 2);
+    assert(*(int *)vector_gap_get(gap, 0) == 42);
+    assert(*(int *)vector_gap_get(gap, 1) == 3);
+
+    vector_gap_erase(gap, 1);
+    vector_gap_erase(gap, 0);
+    assert(vector_gap_empty(gap));
+
+    vector_gap_destroy(gap);
+    vector_destroy(vector);
+}
+
+static void test_gap_compact() {
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    vector_gap_t *gap = vector_gap_create_with_vector(vector);
+    int value = 77;
+    vector_gap_insert(gap, 1, &value);
+    vector_gap_set(gap, 3, &value);
+
+    vector_t *compact = vector_gap_compact(gap);
+    assert_invariants(compact);
+    assert(vector_size(compact) == 4);
+    assert(*(int *)vector_get(compact, 0) == 42);
+    assert(*(int *)vector_get(compact, 1) == 77);
+    assert(*(int *)vector_get(compact, 2) == 23);
+    assert(*(int *)vector_get(compact, 3) == 77);
+
+    vector_destroy(compact);
+    vector_gap_destroy(gap);
+    vector_destroy(vector);
+}
+
+// Structures of arrays
+
+static void test_soa_push_back() {
+    const size_t field_sizes[] = { sizeof(char), sizeof(double), sizeof(int) };
+    vector_soa_t *soa = vector_soa_create(3, field_sizes);
+    assert(vector_soa_field_count(soa) == 3);
+    assert(vector_soa_field_size(soa, 1) == sizeof(double));
+
+    for (int i = 0; i < 100; ++i) {
+        const char c = (char)('a' + i % 26);
+        const double d = i * 0.5;
+        const void *values[] = { &c, &d, &i };
+        vector_soa_push_back(soa, values);
+    }
+
+    assert(vector_soa_size(soa) == 100);
+    assert(vector_soa_capacity(soa) >= 100);
+    const double *doubles = vector_soa_data(soa, 1);
+    const int *ints = vector_soa_data(soa, 2);
+    for (int i = 0; i < 3; ++i) {
+        assert((uintptr_t)vector_soa_data(soa, i) % VECTOR_SOA_ALIGNMENT == 0);
+    }
+    for (int i = 0; i < 100; ++i) {
+        assert(*(char *)vector_soa_get(soa, 0, i) == 'a' + i % 26);
+        assert(doubles[i] == i * 0.5);
+        assert(ints[i] == i);
+    }
+
+    vector_soa_destroy(soa);
+}
+
+static void test_soa_insert_erase() {
+    const size_t field_sizes[] = { sizeof(int), sizeof(short) };
+    vector_soa_t *soa = vector_soa_create(2, field_sizes);
+    for (int i = 0; i < 5; ++i) {
+        const short s = (short)-i;
+        const void *values[] = { &i, &s };
+        vector_soa_push_back(soa, values);
+    }
+    const int i = 42;
+    const short s = -42;
+    const void *values[] = { &i, &s };
+    vector_soa_insert(soa, 2, values);
+    vector_soa_erase(soa, 0);
+
+    const int expected[] = { 1, 42, 2, 3, 4 };
+    assert(vector_soa_size(soa) == 5);
+    for (int j = 0; j < 5; ++j) {
+        assert(*(int *)vector_soa_get(soa, 0, j) == expected[j]);
+        assert(*(short *)vector_soa_get(soa, 1, j) == -expected[j]);
+    }
+
+    vector_soa_resize(soa, 1000);
+    assert(vector_soa_size(soa) == 1000);
+    assert(*(int *)vector_soa_get(soa, 0, 4) == 4);
+    vector_soa_clear(soa);
+    assert(vector_soa_empty(soa));
+
+    vector_soa_destroy(soa);
+}
+
+// Bit vectors
+
+static void test_bitvector_push_back() {
+    bitvector_t *bitvector = bitvector_create();
+    for (int i = 0; i < 200; ++i) {
+        bitvector_push_back(bitvector, i % 3 == 0);
+    }
+
+    assert(bitvector_size(bitvector) == 200);
+    for (int i = 0; i < 200; ++i) {
+        assert(bitvector_get(bitvector, i) == (i % 3 == 0));
+    }
+    assert(bitvector_popcount(bitvector) == 67);
+
+    bitvector_set(bitvector, 0, false);
+    bitvector_set(bitvector, 1, true);
+    assert(bitvector_get(bitvector, 0) == false);
+    assert(bitvector_get(bitvector, 1) == true);
+
+    bitvector_clear(bitvector);
+    assert(bitvector_empty(bitvector));
+    bitvector_destroy(bitvector);
+}
+
+static void test_bitvector_resize() {
+    bitvector_t *bitvector = bitvector_create_with_size(100, true);
+    assert(bitvector_popcount(bitvector) == 100);
+
+    // Shrinking and growing again must not resurrect the removed bits.
+    bitvector_resize(bitvector, 70);
+    bitvector_resize(bitvector, 130);
+    assert(bitvector_popcount(bitvector) == 70);
+    assert(bitvector_get(bitvector, 69) && !bitvector_get(bitvector, 70));
+    assert(bitvector_words(bitvector)[1] == (UINT64_C(1) << 6) - 1);
+
+    bitvector_destroy(bitvector);
+}
+
+static void test_bitvector_find_first_set() {
+    bitvector_t *bitvector = bitvector_create_with_size(1000, false);
+    assert(bitvector_find_first_set(bitvector, 0) == 1000);
+
+    bitvector_set(bitvector, 5, true);
+    bitvector_set(bitvector, 700, true);
+    assert(bitvector_find_first_set(bitvector, 0) == 5);
+    assert(bitvector_find_first_set(bitvector, 5) == 5);
+    assert(bitvector_find_first_set(bitvector, 6) == 700);
+    assert(bitvector_find_first_set(bitvector, 701) == 1000);
+    assert(bitvector_find_first_set(bitvector, 1000) == 1000);
+
+    bitvector_destroy(bitvector);
+}
+
+static void test_bitvector_logic() {
+    bitvector_t *a = bitvector_create_with_size(100, false);
+    bitvector_t *b = bitvector_create_with_size(100, false);
+    for (int i = 0; i < 100; ++i) {
+        bitvector_set(a, i, i % 2 == 0);
+        bitvector_set(b, i, i % 3 == 0);
+    }
+
+    bitvector_t *c = bitvector_create_with_size(100, false);
+    bitvector_or(c, a);
+    bitvector_and(c, b);
+    for (int i = 0; i < 100; ++i) {
+        assert(bitvector_get(c, i) == (i % 6 == 0));
+    }
+    bitvector_or(c, a);
+    bitvector_xor(c, b);
+    for (int i = 0; i < 100; ++i) {
+        assert(bitvector_get(c, i) == ((i % 2 == 0) != (i % 3 == 0)));
+    }
+
+    bitvector_destroy(a);
+    bitvector_destroy(b);
+    bitvector_destroy(c);
+}
+
+// Compressed vectors
+
+static void check_compressed(const vector_t *vector, const vector_codec_t codec) {
+    const size_t size = vector_size(vector);
+    vector_compressed_t *compressed = vector_compress(vector, codec);
+    assert(vector_compressed_size(compressed) == size);
+
+    for (size_t i = 0; i < size; ++i) {
+        assert(vector_compressed_get(compressed, i) == VECTOR_GET(vector, i, uint32_t));
+    }
+
+    uint32_t values[300];
+    vector_compressed_decode(compressed, 100, 300, values);
+    for (size_t i = 0; i < 300; ++i) {
+        assert(values[i] == VECTOR_GET(vector, 100 + i, uint32_t));
+    }
+
+    vector_t *decompressed = vector_decompress(compressed);
+    assert(vector_size(decompressed) == size);
+    assert(memcmp(vector_data(decompressed), vector_data(vector), size * sizeof(uint32_t)) == 0);
+
+    vector_destroy(decompressed);
+    vector_compressed_destroy(compressed);
+}
+
+static void test_compress_for() {
+    vector_t *vector = vector_create(sizeof(uint32_t));
+    for (uint32_t i = 0; i < 1000; ++i) {
+        VECTOR_PUSH_BACK(vector, (uint32_t)(1000000 + (i * 7919) % 200));
+    }
+    VECTOR_PUSH_BACK(vector, UINT32_MAX);
+    VECTOR_PUSH_BACK(vector, (uint32_t)0);
+    check_compressed(vector, VECTOR_CODEC_FOR);
+    check_compressed(vector, VECTOR_CODEC_DELTA);
+
+    vector_compressed_t *compressed = vector_compress(vector, VECTOR_CODEC_FOR);
+    assert(vector_compressed_bytes(compressed) < vector_size(vector) * sizeof(uint32_t) / 2);
+    vector_compressed_destroy(compressed);
+    vector_destroy(vector);
+}
+
+static void test_compress_delta() {
+    vector_t *vector = vector_create(sizeof(uint32_t));
+    uint32_t value = 5;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        value += 1 + (i * 31) % 17;
+        VECTOR_PUSH_BACK(vector, value);
+    }
+    check_compressed(vector, VECTOR_CODEC_DELTA);
+
+    vector_compressed_t *compressed = vector_compress(vector, VECTOR_CODEC_DELTA);
+    assert(vector_compressed_bytes(compressed) < vector_size(vector) * sizeof(uint32_t) / 4);
+    vector_compressed_destroy(compressed);
+
+    vector_t *empty = vector_create(sizeof(uint32_t));
+    compressed = vector_compress(empty, VECTOR_CODEC_DELTA);
+    assert(vector_compressed_size(compressed) == 0);
+    vector_compressed_destroy(compressed);
+    vector_destroy(empty);
+    vector_destroy(vector);
+}
+
+// Searches
+
+static void test_find() {
+    // Cover every element width with a vector kernel plus an odd width, with matches in the
+    // vectorized body and in the scalar tail.
+    const size_t widths[] = { 1, 2, 3, 4, 8 };
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+        const size_t width = widths[w];
+        const size_t size = 1000;
+        const char zero[8] = { 0 };
+        const char needle[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        vector_t *vector = vector_create_with_value(width, size, zero);
+        assert(vector_find(vector, needle) == size);
+        assert(vector_count(vector, needle) == 0);
+        assert(vector_count(vector, zero) == size);
+
+        memcpy(vector_get(vector, size - 1), needle, width);
+        assert(vector_find(vector, needle) == size - 1);
+        memcpy(vector_get(vector, 333), needle, width);
+        assert(vector_find(vector, needle) == 333);
+        assert(vector_count(vector, needle) == 2);
+
+        // A partial match must not count.
+        memcpy(vector_get(vector, 100), needle, width - 1);
+        assert(vector_find(vector, needle) == 333);
+
+        vector_destroy(vector);
+    }
+}
+
+static void test_min_max_index() {
+    vector_t *ints = vector_create(sizeof(int32_t));
+    for (int32_t i = 0; i < 1000; ++i) {
+        VECTOR_PUSH_BACK(ints, (int32_t)((i * 7919) % 1000 - 500));
+    }
+    assert(VECTOR_GET(ints, vector_min_index(ints, VECTOR_SCALAR_INT32), int32_t) == -500);
+    assert(VECTOR_GET(ints, vector_max_index(ints, VECTOR_SCALAR_INT32), int32_t) == 499);
+    VECTOR_SET(ints, 998, (int32_t)-501);
+    assert(vector_min_index(ints, VECTOR_SCALAR_INT32) == 998);
+    vector_destroy(ints);
+
+    vector_t *bytes = vector_create(sizeof(uint8_t));
+    for (int i = 0; i < 300; ++i) {
+        VECTOR_PUSH_BACK(bytes, (uint8_t)(i % 200 + 20));
+    }
+    assert(vector_min_index(bytes, VECTOR_SCALAR_UINT8) == 0);
+    assert(vector_max_index(bytes, VECTOR_SCALAR_UINT8) == 199);
+    vector_destroy(bytes);
+
+    vector_t *int64s = vector_create(sizeof(int64_t));
+    for (int i = 0; i < 100; ++i) {
+        VECTOR_PUSH_BACK(int64s, (int64_t)i * INT64_C(1000000000000));
+    }
+    VECTOR_SET(int64s, 50, INT64_MIN);
+    assert(vector_min_index(int64s, VECTOR_SCALAR_INT64) == 50);
+    assert(vector_max_index(int64s, VECTOR_SCALAR_INT64) == 99);
+    vector_destroy(int64s);
+
+    vector_t *doubles = vector_create(sizeof(double));
+    for (int i = 0; i < 100; ++i) {
+        VECTOR_PUSH_BACK(doubles, (double)i / 3);
+    }
+    VECTOR_SET(doubles, 7, -1.5);
+    assert(vector_min_index(doubles, VECTOR_SCALAR_DOUBLE) == 7);
+    assert(vector_max_index(doubles, VECTOR_SCALAR_DOUBLE) == 99);
+    vector_destroy(doubles);
+
+    vector_t *empty = vector_create(sizeof(float));
+    assert(vector_min_index(empty, VECTOR_SCALAR_FLOAT) == 0);
+    vector_destroy(empty);
+}
+
+// Parallel algorithms
+
+static int compare_ints(const void *first, const void *second) {
+    const int a = *(const int *)first;
+    const int b = *(const int *)second;
+    return (a > b) - (a < b);
+}
+
+typedef struct record_t {
+    uint32_t key;
+    uint32_t payload[2];
+} record_t;
+
+static int compare_records(const void *first, const void *second) {
+    const uint32_t a = ((const record_t *)first)->key;
+    const uint32_t b = ((const record_t *)second)->key;
+    return (a > b) - (a < b);
+}
+
+static void test_parallel_sort() {
+    const size_t sizes[] = { 0, 1, 1000, 100000, 100003 };
+    const size_t thread_counts[] = { 0, 1, 3, 4, 7 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(size_t); ++t) {
+        vector_pool_t *pool = vector_pool_create(thread_counts[t]);
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(size_t); ++s) {
+            vector_t *vector = vector_create_with_size(sizeof(int), sizes[s]);
+            srand(12345);
+            for (size_t i = 0; i < sizes[s]; ++i) {
+                VECTOR_SET(vector, i, rand() % 1000);
+            }
+            vector_t *expected = vector_create_with_vector(vector);
+            qsort(vector_data(expected), vector_size(expected), sizeof(int), compare_ints);
+
+            vector_parallel_sort(pool, vector, compare_ints);
+            assert(memcmp(vector_data(vector), vector_data(expected), sizes[s] * sizeof(int)) == 0);
+
+            vector_destroy(expected);
+            vector_destroy(vector);
+        }
+        vector_pool_destroy(pool);
+    }
+
+    vector_t *records = vector_create_with_size(sizeof(record_t), 50000);
+    for (size_t i = 0; i < 50000; ++i) {
+        record_t *record = vector_get(records, i);
+        record->key = (uint32_t)((i * 7919) % 50000);
+        record->payload[0] = record->key * 3;
+        record->payload[1] = ~record->key;
+    }
+    vector_pool_t *pool = vector_pool_create(5);
+    vector_parallel_sort(pool, records, compare_records);
+    vector_pool_destroy(pool);
+    for (size_t i = 0; i < 50000; ++i) {
+        const record_t *record = vector_get(records, i);
+        assert(record->key == i);
+        assert(record->payload[0] == record->key * 3 && record->payload[1] == ~record->key);
+    }
+    vector_destroy(records);
+}
+
+static void test_parallel_scan() {
+    vector_pool_t *pool = vector_pool_create(4);
+    const size_t size = 100001;
+    vector_t *vector = vector_create_with_size(sizeof(int32_t), size);
+    for (size_t i = 0; i < size; ++i) {
+        VECTOR_SET(vector, i, (int32_t)(i % 7) - 3);
+    }
+    vector_t *exclusive = vector_create_with_vector(vector);
+
+    vector_parallel_scan(pool, vector, VECTOR_SCALAR_INT32, VECTOR_SCAN_INCLUSIVE);
+    vector_parallel_scan(pool, exclusive, VECTOR_SCALAR_INT32, VECTOR_SCAN_EXCLUSIVE);
+    int32_t sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        assert(VECTOR_GET(exclusive, i, int32_t) == sum);
+        sum += (int32_t)(i % 7) - 3;
+        assert(VECTOR_GET(vector, i, int32_t) == sum);
+    }
+    vector_destroy(exclusive);
+    vector_destroy(vector);
+
+    // Integer sums wrap around.
+    vector = vector_create_with_size(sizeof(uint8_t), size);
+    for (size_t i = 0; i < size; ++i) {
+        VECTOR_SET(vector, i, (uint8_t)1);
+    }
+    vector_parallel_scan(pool, vector, VECTOR_SCALAR_UINT8, VECTOR_SCAN_INCLUSIVE);
+    assert(VECTOR_GET(vector, size - 1, uint8_t) == (uint8_t)size);
+    vector_destroy(vector);
+
+    vector = vector_create_with_size(sizeof(double), size);
+    for (size_t i = 0; i < size; ++i) {
+        VECTOR_SET(vector, i, 0.5);
+    }
+    vector_pool_t *three = vector_pool_create(3);
+    vector_parallel_scan(three, vector, VECTOR_SCALAR_DOUBLE, VECTOR_SCAN_EXCLUSIVE);
+    vector_pool_destroy(three);
+    for (size_t i = 0; i < size; ++i) {
+        assert(VECTOR_GET(vector, i, double) == 0.5 * (double)i);
+    }
+    vector_destroy(vector);
+
+    vector = vector_create(sizeof(float));
+    vector_parallel_scan(pool, vector, VECTOR_SCALAR_FLOAT, VECTOR_SCAN_INCLUSIVE);
+    assert(vector_empty(vector));
+    vector_destroy(vector);
+    vector_pool_destroy(pool);
+}
+
+// Concatenates strings of digits, which is associative but not commutative.
+typedef struct digits_t {
+    char text[24];
+} digits_t;
+
+static void append_digits(void *accumulator, const void *value) {
+    digits_t *digits = accumulator;
+    const char *text = ((const digits_t *)value)->text;
+    const size_t length = strlen(digits->text);
+    assert(length + strlen(text) < sizeof(digits->text));
+    memcpy(digits->text + length, text, strlen(text) + 1);
+}
+
+static void add_uint64(void *accumulator, const void *value) {
+    *(uint64_t *)accumulator += *(const uint64_t *)value;
+}
+
+static void test_parallel_reduce() {
+    const size_t size = 100003;
+    vector_t *vector = vector_create_with_size(sizeof(uint64_t), size);
+    for (size_t i = 0; i < size; ++i) {
+        VECTOR_SET(vector, i, (uint64_t)i);
+    }
+    const uint64_t zero = 0;
+    const size_t thread_counts[] = { 0, 1, 3, 8 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(size_t); ++t) {
+        vector_pool_t *pool = vector_pool_create(thread_counts[t]);
+        uint64_t sum = 1;
+        vector_parallel_reduce(pool, vector, &zero, add_uint64, &sum);
+        assert(sum == (uint64_t)size * (size - 1) / 2);
+        vector_pool_destroy(pool);
+    }
+    vector_pool_t *pool = vector_pool_create(4);
+    vector_clear(vector);
+    uint64_t sum = 1;
+    vector_parallel_reduce(pool, vector, &zero, add_uint64, &sum);
+    assert(sum == 0);
+    vector_destroy(vector);
+
+    // The blocks are combined in order.
+    vector = vector_create_with_size(sizeof(digits_t), 20);
+    for (size_t i = 0; i < 20; ++i) {
+        digits_t *digits = vector_get(vector, i);
+        memset(digits, 0, sizeof(digits_t));
+        digits->text[0] = (char)('a' + i);
+    }
+    const digits_t empty = { { 0 } };
+    digits_t digits;
+    vector_parallel_reduce(pool, vector, &empty, append_digits, &digits);
+    assert(strcmp(digits.text, "abcdefghijklmnopqrst") == 0);
+    vector_destroy(vector);
+    vector_pool_destroy(pool);
+}
+
+typedef struct sample_t {
+    double value;
+    uint16_t key;
+    uint8_t flags;
+} sample_t;
+
+static void test_histogram() {
+    const size_t size = 200000;
+    vector_t *samples = vector_create_with_size(sizeof(sample_t), size);
+    for (size_t i = 0; i < size; ++i) {
+        sample_t *sample = vector_get(samples, i);
+        sample->value = (double)i;
+        sample->key = (uint16_t)(i * i % 1031);
+        sample->flags = (uint8_t)(i % 3);
+    }
+
+    const size_t thread_counts[] = { 0, 1, 4 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(size_t); ++t) {
+        vector_pool_t *pool = vector_pool_create(thread_counts[t]);
+
+        // Keys of 1024 and above are not counted.
+        vector_t *buckets = vector_create_with_size(sizeof(size_t), 1024);
+        memset(vector_data(buckets), 0, 1024 * sizeof(size_t));
+        vector_histogram(pool, samples, offsetof(sample_t, key), sizeof(uint16_t), buckets);
+        size_t expected[1024] = { 0 };
+        for (size_t i = 0; i < size; ++i) {
+            const uint16_t key = ((const sample_t *)vector_get(samples, i))->key;
+            if (key < 1024) {
+                ++expected[key];
+            }
+        }
+        assert(memcmp(vector_data(buckets), expected, sizeof(expected)) == 0);
+
+        // Counts accumulate.
+        vector_resize(buckets, 3);
+        memset(vector_data(buckets), 0, 3 * sizeof(size_t));
+        vector_histogram(pool, samples, offsetof(sample_t, flags), 1, buckets);
+        vector_histogram(pool, samples, offsetof(sample_t, flags), 1, buckets);
+        assert(VECTOR_GET(buckets, 0, size_t) == 2 * 66667);
+        assert(VECTOR_GET(buckets, 1, size_t) == 2 * 66667);
+        assert(VECTOR_GET(buckets, 2, size_t) == 2 * 66666);
+        vector_destroy(buckets);
+        vector_pool_destroy(pool);
+    }
+    vector_destroy(samples);
+}
+
+typedef struct parallel_for_context_t {
+    size_t grain;
+    size_t calls;
+} parallel_for_context_t;
+
+// Count the visits to each element, spending more time on every hundredth element so that the
+// threads' ranges cost different amounts.
+static void visit_range(void *context, vector_t *vector, size_t begin, size_t end) {
+    parallel_for_context_t *visits = context;
+    assert(begin < end && end - begin <= visits->grain && end <= vector_size(vector));
+    __atomic_fetch_add(&visits->calls, 1, __ATOMIC_RELAXED);
+    for (size_t i = begin; i < end; ++i) {
+        volatile unsigned spin = 0;
+        for (size_t j = 0; i % 100 == 0 && j < 1000; ++j) {
+            spin += (unsigned)j;
+        }
+        ++*(int *)vector_get(vector, i);
+    }
+}
+
+static void record_thread(void *context, size_t thread, size_t nthreads) {
+    size_t *calls = context;
+    assert(thread < nthreads);
+    __atomic_fetch_add(&calls[thread], 1, __ATOMIC_RELAXED);
+}
+
+static void test_parallel_for() {
+    const size_t thread_counts[] = { 0, 1, 4 };
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(size_t); ++t) {
+        vector_pool_t *pool = vector_pool_create(thread_counts[t]);
+        assert(pool);
+        assert(vector_pool_thread_count(pool) >= 1);
+        if (thread_counts[t] > 0) {
+            assert(vector_pool_thread_count(pool) <= thread_counts[t]);
+        }
+
+        vector_t *vector = vector_create_with_size(sizeof(int), 20000);
+        memset(vector_data(vector), 0, 20000 * sizeof(int));
+        const size_t grains[] = { 1, 7, 1000, 20000, 50000 };
+        for (size_t g = 0; g < sizeof(grains) / sizeof(size_t); ++g) {
+            parallel_for_context_t visits = { grains[g], 0 };
+            vector_parallel_for(pool, vector, grains[g], visit_range, &visits);
+            assert(visits.calls >= (20000 + grains[g] - 1) / grains[g]);
+        }
+        // A grain of zero is chosen by the pool.
+        parallel_for_context_t visits = { 20000, 0 };
+        vector_parallel_for(pool, vector, 0, visit_range, &visits);
+        for (size_t i = 0; i < 20000; ++i) {
+            assert(VECTOR_GET(vector, i, int) == 6);
+        }
+
+        vector_clear(vector);
+        visits.calls = 0;
+        vector_parallel_for(pool, vector, 10, visit_range, &visits);
+        assert(visits.calls == 0);
+
+        // Running a function on every thread calls it once per thread index.
+        size_t calls[8] = { 0 };
+        vector_pool_run(pool, record_thread, calls);
+        for (size_t i = 0; i < 8; ++i) {
+            assert(calls[i] == (i < vector_pool_thread_count(pool) ? 1 : 0));
+        }
+
+        vector_destroy(vector);
+        vector_pool_destroy(pool);
+    }
+}
+
+// Multi-producer buffers
+
+enum { MPSC_PRODUCERS = 4, MPSC_EVENTS = 50000 };
+
+typedef struct mpsc_producer_args_t {
+    vector_mpsc_t *mpsc;
+    uint32_t thread;
+} mpsc_producer_args_t;
+
+// Append (thread, sequence number) pairs, some one at a time and some in batches.
+static void *mpsc_produce(void *arg) {
+    const mpsc_producer_args_t *args = arg;
+    vector_mpsc_producer_t *producer = vector_mpsc_producer_create(args->mpsc);
+    assert(producer);
+    for (uint32_t i = 0; i < MPSC_EVENTS;) {
+        if (i % 1000 == 0 && i + 10 <= MPSC_EVENTS) {
+            uint32_t batch[10][2];
+            for (uint32_t j = 0; j < 10; ++j) {
+                batch[j][0] = args->thread;
+                batch[j][1] = i + j;
+            }
+            vector_mpsc_push_n(producer, batch, 10);
+            i += 10;
+        } else {
+            const uint32_t event[2] = { args->thread, i++ };
+            vector_mpsc_push(producer, event);
+        }
+    }
+    vector_mpsc_producer_destroy(producer);
+    return NULL;
+}
+
+static void test_mpsc() {
+    vector_mpsc_t *mpsc = vector_mpsc_create(2 * sizeof(uint32_t));
+    assert(mpsc);
+    pthread_t threads[MPSC_PRODUCERS];
+    mpsc_producer_args_t args[MPSC_PRODUCERS];
+    for (uint32_t i = 0; i < MPSC_PRODUCERS; ++i) {
+        args[i].mpsc = mpsc;
+        args[i].thread = i;
+        const int error = pthread_create(&threads[i], NULL, mpsc_produce, &args[i]);
+        assert(error == 0);
+    }
+
+    // Drain while the producers run, into an empty vector and into a non-empty one.
+    vector_t *events = vector_create(2 * sizeof(uint32_t));
+    vector_t *batch = vector_create(2 * sizeof(uint32_t));
+    uint32_t next[MPSC_PRODUCERS] = { 0 };
+    size_t total = 0;
+    while (total < MPSC_PRODUCERS * MPSC_EVENTS) {
+        vector_clear(batch);
+        const size_t count = vector_mpsc_drain(mpsc, batch);
+        assert(count == vector_size(batch));
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t *event = vector_get(batch, i);
+            assert(event[0] < MPSC_PRODUCERS && event[1] == next[event[0]]++);
+        }
+        total += count;
+        vector_mpsc_drain(mpsc, events);
+        total += vector_size(events);
+        for (size_t i = 0; i < vector_size(events); ++i) {
+            const uint32_t *event = vector_get(events, i);
+            assert(event[0] < MPSC_PRODUCERS && event[1] == next[event[0]]++);
+        }
+        vector_clear(events);
+    }
+    for (uint32_t i = 0; i < MPSC_PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+        assert(next[i] == MPSC_EVENTS);
+    }
+    assert(vector_mpsc_drain(mpsc, events) == 0);
+
+    // Elements of destroyed producers are kept until drained, and the buffer owns the elements
+    // and producers left at destruction.
+    vector_mpsc_producer_t *producer = vector_mpsc_producer_create(mpsc);
+    const uint32_t event[2] = { 7, 8 };
+    vector_mpsc_push(producer, event);
+    vector_mpsc_producer_destroy(producer);
+    producer = vector_mpsc_producer_create(mpsc);
+    vector_mpsc_push(producer, event);
+    vector_mpsc_push_n(producer, NULL, 0);
+    assert(vector_mpsc_drain(mpsc, events) == 2);
+    assert(memcmp(vector_back(events), event, sizeof(event)) == 0);
+    vector_mpsc_push(producer, event);
+
+    vector_destroy(batch);
+    vector_destroy(events);
+    vector_mpsc_destroy(mpsc);
+}
+
+// Read-copy-update vectors
+
+enum { RCU_READERS = 3, RCU_VERSIONS = 2000 };
+
+typedef struct rcu_reader_args_t {
+    vector_rcu_t *rcu;
+    int done;
+} rcu_reader_args_t;
+
+// Check that every version seen is complete: version k has k % 100 + 1 elements, all equal to k.
+static void *rcu_read(void *arg) {
+    rcu_reader_args_t *args = arg;
+    vector_rcu_reader_t *reader = vector_rcu_reader_create(args->rcu);
+    assert(reader);
+    size_t last = 0;
+    while (!__atomic_load_n(&args->done, __ATOMIC_ACQUIRE)) {
+        const vector_t *version = vector_rcu_read_lock(reader);
+        if (!vector_empty(version)) {
+            const size_t k = VECTOR_GET(version, 0, size_t);
+            assert(k >= last && vector_size(version) == k % 100 + 1);
+            for (size_t i = 0; i < vector_size(version); ++i) {
+                assert(VECTOR_GET(version, i, size_t) == k);
+            }
+            last = k;
+        }
+        vector_rcu_read_unlock(reader);
+    }
+    vector_rcu_reader_destroy(reader);
+    return NULL;
+}
+
+static void sum_run(void *context, const void *elements, size_t count) {
+    const uint64_t *values = elements;
+    for (size_t i = 0; i < count; ++i) {
+        *(uint64_t *)context += values[i];
+    }
+}
+
+static void test_external() {
+    // Pages of 512 elements, at most 4 of them in memory.
+    vector_external_t *external = vector_external_create(sizeof(uint64_t), 4096, 4, NULL);
+    assert(external && vector_external_size(external) == 0);
+    assert(vector_external_element_size(external) == sizeof(uint64_t));
+
+    const uint64_t count = 50000;
+    for (uint64_t i = 0; i < count; ++i) {
+        vector_external_push_back(external, &i);
+    }
+    assert(vector_external_size(external) == count);
+
+    // Pages in the file and in memory read back, in any order.
+    assert(*(const uint64_t *)vector_external_get(external, 0) == 0);
+    for (uint64_t i = 0; i < count; i += 997) {
+        assert(*(const uint64_t *)vector_external_get(external, count - 1 - i) == count - 1 - i);
+    }
+
+    // Changed pages are written back when they are evicted.
+    for (uint64_t i = 0; i < count; i += 1000) {
+        vector_external_set(external, i, &(uint64_t){ 0 });
+    }
+    uint64_t sum = 0;
+    vector_external_scan(external, 0, count, sum_run, &sum);
+    uint64_t expected = count * (count - 1) / 2;
+    for (uint64_t i = 0; i < count; i += 1000) {
+        expected -= i;
+    }
+    assert(sum == expected);
+
+    // Ranges need not start or end on a page boundary.
+    sum = 0;
+    vector_external_set_readahead(external, 0);
+    vector_external_scan(external, 600, 1601, sum_run, &sum);
+    assert(sum == (600 + 1600) * 1001 / 2 - 1000);
+    vector_external_destroy(external);
+
+    assert(!vector_external_create(sizeof(uint64_t), 0, 1, "/nonexistent/directory"));
+}
+
+static void test_rcu() {
+    vector_rcu_t *rcu = vector_rcu_create(sizeof(size_t));
+    assert(rcu);
+
+    // A version held by a reader is not reclaimed until the reader lets go of it.
+    vector_rcu_reader_t *reader = vector_rcu_reader_create(rcu);
+    const vector_t *empty = vector_rcu_read_lock(reader);
+    assert(vector_empty(empty));
+    vector_t *back = vector_rcu_back(rcu);
+    const size_t one = 1;
+    vector_push_back(back, &one);
+    vector_rcu_publish(rcu, back);
+    assert(vector_size(empty) == 0 && vector_rcu_reclaim(rcu) == 1);
+    vector_rcu_read_unlock(reader);
+    assert(vector_rcu_reclaim(rcu) == 0);
+    const vector_t *current = vector_rcu_read_lock(reader);
+    assert(current == back && VECTOR_GET(current, 0, size_t) == 1);
+    vector_rcu_read_unlock(reader);
+
+    // Publishing alternates between two buffers once the old one is free.
+    back = vector_rcu_back(rcu);
+    assert(back == empty && vector_empty(back));
+    vector_rcu_publish(rcu, back);
+    assert(vector_rcu_back(rcu) == current);
+    vector_rcu_publish(rcu, (vector_t *)current);
+    vector_rcu_reader_destroy(reader);
+
+    pthread_t threads[RCU_READERS];
+    rcu_reader_args_t args = { rcu, 0 };
+    for (size_t i = 0; i < RCU_READERS; ++i) {
+        const int error = pthread_create(&threads[i], NULL, rcu_read, &args);
+        assert(error == 0);
+    }
+    for (size_t k = 1; k <= RCU_VERSIONS; ++k) {
+        back = vector_rcu_back(rcu);
+        assert(back);
+        for (size_t i = 0; i < k % 100 + 1; ++i) {
+            vector_push_back(back, &k);
+        }
+        vector_rcu_publish(rcu, back);
+    }
+    __atomic_store_n(&args.done, 1, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < RCU_READERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(vector_rcu_reclaim(rcu) == 0);
+
+    // Readers left registered are destroyed with the vector.
+    vector_rcu_reader_create(rcu);
+    vector_rcu_destroy(rcu);
+}
+
 // System interactions
 
 static void test_custom_abort_func() {
@@ -530,6 +1758,78 @@ static void test_custom_abort_func() {
     vector_destroy(vector);
 }
 
+static void test_check_failed() {
+    ABORT_FUNC_CALLED = false;
+    VFPRINTF_FUNC_CALLED = false;
+    vector_set_global_abort_func(abort_func);
+    vector_set_global_vfprintf_func(vfprintf_func);
+
+    vector_check_failed("index < size", __FILE__, __LINE__);
+    assert(ABORT_FUNC_CALLED == true);
+    assert(VFPRINTF_FUNC_CALLED == true);
+
+    vector_set_global_abort_func(vector_default_global_abort_func);
+    vector_set_global_vfprintf_func(vector_default_global_vfprintf_func);
+}
+
+// Only meaningful in tests_cheap, where this file and the library are both compiled with cheap checks.
+static void test_cheap_checks() {
+#if VECTOR_CHECK_LEVEL == VECTOR_CHECK_CHEAP
+    ABORT_FUNC_CALLED = false;
+    vector_set_global_abort_func(abort_func);
+    vector_set_global_vfprintf_func(vfprintf_func);
+
+    // A failed check calls the abort function instead of assert(), so execution continues here.
+    VECTOR_CHECK(ABORT_FUNC_CALLED);
+    assert(ABORT_FUNC_CALLED == true);
+
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    ABORT_FUNC_CALLED = false;
+    vector_erase(vector, 5);
+    assert(ABORT_FUNC_CALLED == true);
+    assert(vector_size(vector) == 3);
+    assert(memcmp(vector_data(vector), values, sizeof(values)) == 0);
+
+    vector_gap_t *gap = vector_gap_create_with_vector(vector);
+    ABORT_FUNC_CALLED = false;
+    vector_gap_erase(gap, 3);
+    assert(ABORT_FUNC_CALLED == true);
+    ABORT_FUNC_CALLED = false;
+    vector_gap_insert(gap, 4, &values[0]);
+    assert(ABORT_FUNC_CALLED == true);
+    assert(vector_gap_size(gap) == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        assert(*(int *)vector_gap_get(gap, i) == values[i]);
+    }
+    vector_gap_destroy(gap);
+    vector_destroy(vector);
+
+    const size_t field_sizes[] = { sizeof(int), sizeof(short) };
+    vector_soa_t *soa = vector_soa_create(2, field_sizes);
+    const void *missing[] = { &values[0], NULL };
+    ABORT_FUNC_CALLED = false;
+    vector_soa_push_back(soa, missing);
+    assert(ABORT_FUNC_CALLED == true);
+    assert(vector_soa_empty(soa));
+    vector_soa_destroy(soa);
+
+    bitvector_t *a = bitvector_create_with_size(10, true);
+    bitvector_t *b = bitvector_create_with_size(20, false);
+    ABORT_FUNC_CALLED = false;
+    bitvector_and(a, b);
+    assert(ABORT_FUNC_CALLED == true);
+    for (size_t i = 0; i < 10; ++i) {
+        assert(bitvector_get(a, i));
+    }
+    bitvector_destroy(a);
+    bitvector_destroy(b);
+
+    vector_set_global_abort_func(vector_default_global_abort_func);
+    vector_set_global_vfprintf_func(vector_default_global_vfprintf_func);
+#endif
+}
+
 static void test_custom_realloc_func() {
     vector_t *vector = vector_create(sizeof(int));
 
@@ -579,6 +1879,183 @@ static void test_custom_memmove_func() {
     vector_destroy(vector);
 }
 
+static void test_global_hooks() {
+    const vector_hooks_t *defaults = vector_get_global_hooks();
+    assert(defaults->realloc == vector_default_global_realloc_func);
+    assert(defaults->free == vector_default_global_free_func);
+
+    vector_hooks_t hooks = *defaults;
+    hooks.realloc = realloc_func;
+    hooks.free = free_func;
+    vector_set_global_hooks(&hooks);
+    assert(vector_get_global_realloc_func() == realloc_func);
+    assert(vector_get_global_free_func() == free_func);
+    assert(vector_get_global_memcpy_func() == vector_default_global_memcpy_func);
+
+    // Earlier tables stay valid after being replaced.
+    assert(defaults->realloc == vector_default_global_realloc_func);
+
+    REALLOC_FUNC_CALLED = false;
+    FREE_FUNC_CALLED = false;
+    vector_t *vector = vector_create_with_size(sizeof(int), 10);
+    vector_destroy(vector);
+    assert(REALLOC_FUNC_CALLED == true);
+    assert(FREE_FUNC_CALLED == true);
+
+    // Setting a single function keeps the rest of the table.
+    vector_set_global_memcpy_func(memcpy_func);
+    assert(vector_get_global_hooks()->realloc == realloc_func);
+    assert(vector_get_global_hooks()->memcpy == memcpy_func);
+
+    vector_set_global_hooks(defaults);
+    assert(vector_get_global_realloc_func() == vector_default_global_realloc_func);
+    assert(vector_get_global_memcpy_func() == vector_default_global_memcpy_func);
+}
+
+static size_t REALLOC_CALLS = 0;
+
+static void *counting_cache_realloc_func(void *ptr, size_t size) {
+    ++REALLOC_CALLS;
+    return vector_cache_realloc_func(ptr, size);
+}
+
+static void *counting_realloc_func(void *ptr, size_t size) {
+    ++REALLOC_CALLS;
+    return vector_default_global_realloc_func(ptr, size);
+}
+
+static void test_try_expand() {
+    assert(vector_get_global_try_expand_func() == vector_default_global_try_expand_func);
+
+    // Setting the realloc function drops the try-expand function, which may not understand its blocks.
+    vector_set_global_realloc_func(counting_cache_realloc_func);
+    vector_set_global_free_func(vector_cache_free_func);
+    assert(vector_get_global_try_expand_func() == NULL);
+    vector_set_global_try_expand_func(vector_cache_try_expand_func);
+
+    // Growing within the allocation's capacity class does not call realloc, and the vector's
+    // capacity is still what was asked for.
+    vector_t *vector = vector_create(sizeof(int));
+    vector_reserve(vector, 20);
+    VECTOR_PUSH_BACK(vector, 42);
+    REALLOC_CALLS = 0;
+    void *data = vector_data(vector);
+    vector_reserve(vector, 30);
+    assert(REALLOC_CALLS == 0 && vector_data(vector) == data && vector_capacity(vector) == 30);
+    assert(VECTOR_GET(vector, 0, int) == 42);
+    vector_reserve(vector, 40);
+    assert(REALLOC_CALLS == 1 && vector_capacity(vector) == 40);
+    assert(VECTOR_GET(vector, 0, int) == 42);
+    vector_destroy(vector);
+    vector_cache_flush();
+
+    // The default try-expand function grows into the slack of the system allocator's blocks.
+    vector_set_global_realloc_func(counting_realloc_func);
+    vector_set_global_free_func(vector_default_global_free_func);
+    vector_set_global_try_expand_func(vector_default_global_try_expand_func);
+    vector = vector_create(1);
+    vector_reserve(vector, 1);
+    REALLOC_CALLS = 0;
+    vector_reserve(vector, 8);
+    // Sanitizers replace the allocator with one that has no slack.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+    assert(REALLOC_CALLS == 0);
+#endif
+    assert(vector_capacity(vector) == 8);
+    vector_destroy(vector);
+
+    vector_set_global_realloc_func(vector_default_global_realloc_func);
+    assert(vector_get_global_try_expand_func() == vector_default_global_try_expand_func);
+}
+
+static void test_trace() {
+    vector_trace_start(1);
+    vector_t *vector = vector_create(sizeof(int));
+    for (int i = 0; i < 100; ++i) {
+        VECTOR_PUSH_BACK(vector, i);  // Grows to capacities 1, 2, 4, ..., 128.
+    }
+
+    vector_trace_record_t records[16];
+    assert(vector_trace_records(records, 16) == 8);
+    for (size_t i = 0; i < 8; ++i) {
+        assert(records[i].element_size == sizeof(int));
+        assert(records[i].new_capacity == (size_t)1 << i);
+        assert(records[i].old_capacity == (i == 0 ? 0 : (size_t)1 << (i - 1)));
+#if defined(__GNUC__)
+        assert(records[i].call_site == records[0].call_site);
+        assert(records[i].call_site != NULL);
+#endif
+    }
+    assert(vector_trace_records(records, 3) == 3);
+    assert(records[2].new_capacity == 128);
+
+    FILE *stream = tmpfile();
+    assert(vector_trace_dump(stream) == 8);
+    fclose(stream);
+
+    vector_trace_start(4);
+    vector_reserve(vector, 1000);
+    vector_reserve(vector, 2000);
+    vector_reserve(vector, 3000);
+    assert(vector_trace_records(records, 16) == 0);
+    vector_reserve(vector, 4000);
+    assert(vector_trace_records(records, 16) == 1);
+    assert(records[0].old_capacity == 3000 && records[0].new_capacity == 4000);
+
+    vector_trace_stop();
+    assert(vector_get_global_grow_func() == NULL);
+    vector_reserve(vector, 5000);
+    assert(vector_trace_records(records, 16) == 1);
+    vector_destroy(vector);
+}
+
+static void test_tuned_memcpy_func() {
+    char src[512], dst[512], expected[512];
+    for (int i = 0; i < 512; ++i) {
+        src[i] = (char)(i * 31 + 7);
+    }
+
+    // Small copies, ordinary copies and streaming copies at odd alignments.
+    const size_t threshold = vector_streaming_threshold();
+    vector_set_streaming_threshold(256);
+    for (size_t n = 0; n <= 400; ++n) {
+        const size_t offset = n % 13;
+        memset(dst, 0, sizeof(dst));
+        memset(expected, 0, sizeof(expected));
+        memcpy(expected + offset, src + 3, n);
+        assert(vector_tuned_memcpy_func(dst + offset, src + 3, n) == dst + offset);
+        assert(memcmp(dst, expected, sizeof(dst)) == 0);
+    }
+    vector_set_streaming_threshold(threshold);
+}
+
+static void test_tuned_memmove_func() {
+    char buffer[512], expected[512];
+    for (size_t n = 0; n <= 200; ++n) {
+        for (int shift = -9; shift <= 9; shift += 3) {
+            for (int i = 0; i < 512; ++i) {
+                buffer[i] = expected[i] = (char)(i * 17 + 1);
+            }
+            memmove(expected + 100 + shift, expected + 100, n);
+            assert(vector_tuned_memmove_func(buffer + 100 + shift, buffer + 100, n) == buffer + 100 + shift);
+            assert(memcmp(buffer, expected, sizeof(buffer)) == 0);
+        }
+    }
+
+    vector_set_global_memcpy_func(vector_tuned_memcpy_func);
+    vector_set_global_memmove_func(vector_tuned_memmove_func);
+    const int values[] = { 42, 23, 7 };
+    vector_t *vector = vector_create_with_values(sizeof(int), 3, values);
+    VECTOR_INSERT(vector, 1, 77);
+    vector_erase(vector, 0);
+    assert(vector_size(vector) == 3);
+    assert(VECTOR_GET(vector, 0, int) == 77);
+    assert(VECTOR_GET(vector, 2, int) == 7);
+    vector_destroy(vector);
+    vector_set_global_memcpy_func(vector_default_global_memcpy_func);
+    vector_set_global_memmove_func(vector_default_global_memmove_func);
+}
+
 static void test_custom_vfprintf_func() {
     vector_t *vector = vector_create(sizeof(int));
 
@@ -595,6 +2072,121 @@ static void test_custom_vfprintf_func() {
     vector_destroy(vector);
 }
 
+static void test_cache_funcs() {
+    vector_set_global_realloc_func(vector_cache_realloc_func);
+    vector_set_global_free_func(vector_cache_free_func);
+    assert(vector_cache_count() == 0);
+
+    vector_t *vector = vector_create_with_size(sizeof(int), 100);
+    VECTOR_SET(vector, 99, 42);
+    void *data = vector_data(vector);
+    vector_reserve(vector, 120);  // Fits in the same capacity class.
+    assert(vector_data(vector) == data);
+    vector_reserve(vector, 1000);
+    assert(VECTOR_GET(vector, 99, int) == 42);
+    data = vector_data(vector);
+    vector_destroy(vector);
+    assert(vector_cache_count() == 3);  // The vector itself and both of its buffers.
+
+    // A vector of the same capacity class on the same thread reuses the cached buffer.
+    vector = vector_create_with_size(sizeof(int), 900);
+    assert(vector_data(vector) == data);
+    vector_size_to_fit(vector);
+    vector_resize(vector, 0);
+    vector_size_to_fit(vector);
+    assert(vector_data(vector) == NULL);
+    vector_destroy(vector);
+
+    // Allocations too large to cache go straight to the system allocator.
+    vector = vector_create_with_size(1, VECTOR_CACHE_MAX_BYTES + 1);
+    vector_reserve(vector, 2 * VECTOR_CACHE_MAX_BYTES);
+    vector_destroy(vector);
+
+    assert(vector_cache_count() > 0);
+    vector_cache_flush();
+    assert(vector_cache_count() == 0);
+    vector_set_global_realloc_func(vector_default_global_realloc_func);
+    vector_set_global_free_func(vector_default_global_free_func);
+}
+
+static void test_numa_funcs() {
+    vector_set_global_realloc_func(vector_numa_realloc_func);
+    vector_set_global_free_func(vector_numa_free_func);
+    vector_set_global_try_expand_func(vector_numa_try_expand_func);
+    const size_t nodes = vector_numa_node_count();
+    assert(nodes >= 1);
+
+    // Small allocations come from the system allocator; large ones are mapped with the policy.
+    vector_t *vector = vector_create_with_size(sizeof(int), 100);
+    VECTOR_SET(vector, 99, 42);
+    vector_numa_set_policy(VECTOR_NUMA_INTERLEAVE, 0);
+    vector_reserve(vector, VECTOR_NUMA_MIN_BYTES);
+    assert(VECTOR_GET(vector, 99, int) == 42);
+    vector_numa_set_policy(VECTOR_NUMA_PREFERRED, 0);
+    vector_reserve(vector, 2 * VECTOR_NUMA_MIN_BYTES);
+    assert(VECTOR_GET(vector, 99, int) == 42);
+    const int node = vector_numa_node_of(vector_get(vector, 99));
+    assert(node == -1 || (node >= 0 && (size_t)node < nodes));
+    vector_numa_set_policy(VECTOR_NUMA_DEFAULT, 0);
+    vector_reserve(vector, 3 * VECTOR_NUMA_MIN_BYTES);
+    assert(VECTOR_GET(vector, 99, int) == 42);
+
+    // A small shrink keeps the mapping; a large one moves back to the system allocator.
+    void *data = vector_data(vector);
+    vector_shrink_to(vector, 2 * VECTOR_NUMA_MIN_BYTES);
+    assert(vector_data(vector) == data);
+    vector_shrink_to(vector, 100);
+    assert(VECTOR_GET(vector, 99, int) == 42);
+    vector_destroy(vector);
+
+#if defined(__linux__)
+    // A mapped block grows in place when the addresses after it are free. Mappings are placed
+    // top-down, so a block freed just before growing usually leaves room above the vector's block,
+    // but the vector may instead have been placed in a gap left by earlier mappings. The block ends
+    // where the vector's capacity does, so check that the addresses after it are free by asking for
+    // a mapping there.
+    void *above = vector_numa_realloc_func(NULL, 4 * VECTOR_NUMA_MIN_BYTES);
+    vector = vector_create_with_size(1, VECTOR_NUMA_MIN_BYTES);
+    memset(vector_data(vector), 7, VECTOR_NUMA_MIN_BYTES);
+    vector_numa_free_func(above);
+    data = vector_data(vector);
+    char *end = (char *)data + vector_capacity(vector);
+    void *probe = mmap(end, 2 * VECTOR_NUMA_MIN_BYTES, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    const bool room_above = probe == end;
+    if (probe != MAP_FAILED) {
+        munmap(probe, 2 * VECTOR_NUMA_MIN_BYTES);
+    }
+    vector_reserve(vector, 3 * VECTOR_NUMA_MIN_BYTES);
+    assert(vector_capacity(vector) == 3 * VECTOR_NUMA_MIN_BYTES);
+    // Sanitizers map memory of their own, which may take the freed addresses.
+#if !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+    assert(!room_above || vector_data(vector) == data);
+#endif
+    for (size_t i = 0; i < VECTOR_NUMA_MIN_BYTES; ++i) {
+        assert(VECTOR_GET(vector, i, char) == 7);
+    }
+    vector_destroy(vector);
+#endif
+
+    // Each pool thread zeroes the part of the new elements it will start on in vector_parallel_for().
+    vector_pool_t *pool = vector_pool_create(3);
+    vector = vector_create(sizeof(uint64_t));
+    vector_reserve(vector, VECTOR_NUMA_MIN_BYTES);
+    vector_resize(vector, 10);
+    VECTOR_SET(vector, 9, (uint64_t)7);
+    vector_numa_first_touch(vector, VECTOR_NUMA_MIN_BYTES / sizeof(uint64_t), pool);
+    assert(vector_size(vector) == VECTOR_NUMA_MIN_BYTES / sizeof(uint64_t));
+    assert(VECTOR_GET(vector, 9, uint64_t) == 7);
+    for (size_t i = 10; i < vector_size(vector); ++i) {
+        assert(VECTOR_GET(vector, i, uint64_t) == 0);
+    }
+    vector_destroy(vector);
+    vector_pool_destroy(pool);
+
+    vector_set_global_realloc_func(vector_default_global_realloc_func);
+    vector_set_global_free_func(vector_default_global_free_func);
+}
+
 struct test_info_t {
     const char *name;
     test_func_t func;
@@ -616,6 +2208,12 @@ int main(int argc, char *argv[]) {
         TEST_INFO_CREATE(test_clear),
         TEST_INFO_CREATE(test_resize_up),
         TEST_INFO_CREATE(test_resize_down),
+        TEST_INFO_CREATE(test_inline_accessors),
+        TEST_INFO_CREATE(test_adopt),
+        TEST_INFO_CREATE(test_release),
+        TEST_INFO_CREATE(test_resize_default),
+        TEST_INFO_CREATE(test_reserve_additional),
+        TEST_INFO_CREATE(test_shrink_to),
         TEST_INFO_CREATE(test_size_to_fit),
         TEST_INFO_CREATE(test_size_to_fit_fail),
         TEST_INFO_CREATE(test_set),
@@ -628,11 +2226,15 @@ int main(int argc, char *argv[]) {
         TEST_INFO_CREATE(test_data),
         TEST_INFO_CREATE(test_push_back_empty),
         TEST_INFO_CREATE(test_push_back),
+        TEST_INFO_CREATE(test_emplace_back),
+        TEST_INFO_CREATE(test_emplace_back_n),
         TEST_INFO_CREATE(test_pop_back),
         TEST_INFO_CREATE(test_pop_back_to_empty),
         TEST_INFO_CREATE(test_convenience_push_back),
         TEST_INFO_CREATE(test_insert_empty),
         TEST_INFO_CREATE(test_insert),
+        TEST_INFO_CREATE(test_insert_middle),
+        TEST_INFO_CREATE(test_emplace),
         TEST_INFO_CREATE(test_convenience_insert),
         TEST_INFO_CREATE(test_erase),
         TEST_INFO_CREATE(test_erase_to_empty),
@@ -641,12 +2243,47 @@ int main(int argc, char *argv[]) {
         TEST_INFO_CREATE(test_expansion_factor),
         TEST_INFO_CREATE(test_capacity_empty),
         TEST_INFO_CREATE(test_capacity),
+        TEST_INFO_CREATE(test_cursor),
+        TEST_INFO_CREATE(test_cursor_strided),
+        TEST_INFO_CREATE(test_element_funcs_destroy),
+        TEST_INFO_CREATE(test_element_funcs_copy),
+        TEST_INFO_CREATE(test_element_funcs_move),
+        TEST_INFO_CREATE(test_gap_insert_at_cursor),
+        TEST_INFO_CREATE(test_gap_erase),
+        TEST_INFO_CREATE(test_gap_compact),
+        TEST_INFO_CREATE(test_soa_push_back),
+        TEST_INFO_CREATE(test_soa_insert_erase),
+        TEST_INFO_CREATE(test_bitvector_push_back),
+        TEST_INFO_CREATE(test_bitvector_resize),
+        TEST_INFO_CREATE(test_bitvector_find_first_set),
+        TEST_INFO_CREATE(test_bitvector_logic),
+        TEST_INFO_CREATE(test_compress_for),
+        TEST_INFO_CREATE(test_compress_delta),
+        TEST_INFO_CREATE(test_find),
+        TEST_INFO_CREATE(test_min_max_index),
+        TEST_INFO_CREATE(test_parallel_sort),
+        TEST_INFO_CREATE(test_parallel_scan),
+        TEST_INFO_CREATE(test_parallel_reduce),
+        TEST_INFO_CREATE(test_histogram),
+        TEST_INFO_CREATE(test_parallel_for),
+        TEST_INFO_CREATE(test_mpsc),
+        TEST_INFO_CREATE(test_rcu),
+        TEST_INFO_CREATE(test_external),
         TEST_INFO_CREATE(test_custom_abort_func),
+        TEST_INFO_CREATE(test_check_failed),
+        TEST_INFO_CREATE(test_cheap_checks),
         TEST_INFO_CREATE(test_custom_free_func),
         TEST_INFO_CREATE(test_custom_memcpy_func),
         TEST_INFO_CREATE(test_custom_memmove_func),
         TEST_INFO_CREATE(test_custom_realloc_func),
         TEST_INFO_CREATE(test_custom_vfprintf_func),
+        TEST_INFO_CREATE(test_global_hooks),
+        TEST_INFO_CREATE(test_try_expand),
+        TEST_INFO_CREATE(test_trace),
+        TEST_INFO_CREATE(test_tuned_memcpy_func),
+        TEST_INFO_CREATE(test_tuned_memmove_func),
+        TEST_INFO_CREATE(test_cache_funcs),
+        TEST_INFO_CREATE(test_numa_funcs),
     };
 
     const size_t num_tests = sizeof(tests) / sizeof(test_info_t);
@@ -0,0 +1,185 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "vector_cvec.hpp"
+
+typedef void (*test_func_t)(void);
+
+static void test_create() {
+    cvec<int> empty;
+    assert(empty.empty());
+    assert(empty.size() == 0);
+
+    cvec<int> zeros(5);
+    assert(zeros.size() == 5);
+    assert(std::all_of(zeros.begin(), zeros.end(), [](int value) { return value == 0; }));
+
+    cvec<int> sevens(3, 7);
+    assert(sevens.size() == 3 && sevens[2] == 7);
+
+    cvec<int> values = { 42, 23, 7 };
+    assert(values.size() == 3);
+    assert(values.front() == 42 && values.back() == 7);
+}
+
+static void test_access() {
+    cvec<int> values = { 42, 23, 7 };
+    values[1] = 5;
+    assert(values.at(1) == 5);
+    assert(values.data()[2] == 7);
+
+    bool thrown = false;
+    try {
+        values.at(3);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+static void test_algorithms() {
+    cvec<int> values;
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(99 - i);
+    }
+    std::sort(values.begin(), values.end());
+    assert(std::is_sorted(values.cbegin(), values.cend()));
+    assert(std::accumulate(values.begin(), values.end(), 0) == 4950);
+    assert(*values.rbegin() == 99);
+
+    values.erase(std::remove_if(values.begin(), values.end(), [](int value) { return value % 2; }), values.end());
+    assert(values.size() == 50);
+}
+
+static void test_move() {
+    cvec<int> values = { 42, 23, 7 };
+    const int *data = values.data();
+
+    cvec<int> moved(std::move(values));
+    assert(moved.data() == data);
+    assert(moved.size() == 3);
+
+    // A moved-from vector is empty and can be used again.
+    assert(values.empty());
+    values.push_back(1);
+    assert(values.size() == 1 && values[0] == 1);
+
+    cvec<int> assigned = { 5 };
+    assigned = std::move(moved);
+    assert(assigned.data() == data);
+    assert(assigned.size() == 3);
+    assert(moved.empty());
+
+    cvec<int> copied(assigned);
+    assert(copied.data() != data);
+    assert(std::equal(copied.begin(), copied.end(), assigned.begin()));
+}
+
+static void test_share_with_c() {
+    cvec<int> values = { 42, 23, 7 };
+    const int *data = values.data();
+
+    // Hand the storage to C code and take it back without copying.
+    vector_t *vector = values.release();
+    assert(values.empty());
+    assert(values.get() != vector);
+    assert(vector_size(vector) == 3);
+    assert(vector_data(vector) == data);
+    cvec<int> adopted(vector);
+    assert(adopted.data() == data);
+    assert(adopted[0] == 42);
+}
+
+static void test_owning_elements() {
+    cvec<std::string> strings;
+    for (int i = 0; i < 100; ++i) {
+        strings.emplace_back(50, static_cast<char>('a' + i % 26));
+    }
+    strings.push_back(strings[0]);  // Copies from an element while growing.
+    assert(strings.size() == 101);
+    assert(strings[100] == std::string(50, 'a'));
+    assert(strings[27] == std::string(50, 'b'));
+
+    cvec<std::string> copy(strings);
+    assert(copy[27] == strings[27]);
+    strings.erase(strings.begin());
+    assert(strings[0] == std::string(50, 'b'));
+    strings.resize(10);
+    assert(strings.size() == 10);
+
+    cvec<std::unique_ptr<int>> pointers;
+    for (int i = 0; i < 100; ++i) {
+        pointers.emplace_back(new int(i));
+    }
+    assert(*pointers[99] == 99);
+    cvec<std::unique_ptr<int>> moved(std::move(pointers));
+    assert(*moved[42] == 42);
+}
+
+#if defined(__cpp_lib_span)
+static int sum(std::span<const int> values) {
+    return std::accumulate(values.begin(), values.end(), 0);
+}
+
+static void test_span() {
+    const cvec<int> values = { 42, 23, 7 };
+    assert(sum(values) == 72);
+
+    cvec<int> mutable_values = { 1, 2, 3 };
+    std::span<int> span = mutable_values;
+    span[0] = 10;
+    assert(mutable_values[0] == 10);
+}
+#endif
+
+struct test_info_t {
+    const char *name;
+    test_func_t func;
+};
+
+#define TEST_INFO_CREATE(test_func) { #test_func, test_func }
+
+int main(int argc, char *argv[]) {
+    test_info_t tests[] = {
+        TEST_INFO_CREATE(test_create),
+        TEST_INFO_CREATE(test_access),
+        TEST_INFO_CREATE(test_algorithms),
+        TEST_INFO_CREATE(test_move),
+        TEST_INFO_CREATE(test_share_with_c),
+        TEST_INFO_CREATE(test_owning_elements),
+#if defined(__cpp_lib_span)
+        TEST_INFO_CREATE(test_span),
+#endif
+    };
+
+    const size_t num_tests = sizeof(tests) / sizeof(test_info_t);
+    for (size_t i = 0; i < num_tests; ++i) {
+        printf("%s\n", tests[i].name);
+        tests[i].func();
+    }
+
+    printf("%i tests pass.\n", (int)num_tests);
+
+    return 0;
+}
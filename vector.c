@@ -15,45 +15,117 @@
  */
 
 #include "vector.h"
-#include "vector_system.h"
+#include "vector_check.h"
+#include "vector_inline.h"
+#include "vector_system_internal.h"
 
 #include <assert.h>
 #include <stdint.h>
 
-// TODO: Audit each function for what happens if the assert() condition fails in release mode.
+// Arguments are checked with VECTOR_CHECK(), which stays enabled as a cheap check in release builds
+// unless VECTOR_CHECK_LEVEL says otherwise. If the abort function returns after a failed check,
+// functions that would otherwise write out of bounds return without changing the vector.
 
 static const size_t VECTOR_MAX_SIZE = SIZE_MAX;
 
-struct vector_t {
-    size_t element_size;
-    size_t size;
-    size_t capacity;
-    float expansion_factor;
-    void *data;
-};
-
-static void vector_abort();
-static void vector_free(void *ptr);
-static void *vector_memcpy(void *restrict dst, const void *restrict src, size_t n);
-static void *vector_memmove(void *dst, const void *src, size_t len);
-static void *vector_realloc(void *ptr, const size_t size);
-static void vector_fprintf(FILE * restrict stream, const char * restrict format, ...);
+// struct vector_t is defined in vector_inline.h so that its accessors can be inlined by callers.
 
 static size_t capacity_for_size(const size_t cur_size, const size_t required_size, const float expansion_factor);
 
+// The address public functions were called from, reported to the global grow function. Public
+// functions pass it to the internal functions below so that growth is attributed to user code.
+#if defined(__GNUC__)
+#   define CALL_SITE() __builtin_return_address(0)
+#else
+#   define CALL_SITE() NULL
+#endif
+
+static void reserve(vector_t *vector, const size_t capacity, const void *call_site);
+static void resize(vector_t *vector, const size_t size, const void *call_site);
+static void *emplace_back_n(vector_t *vector, const size_t count, const void *call_site);
+static void *emplace(vector_t *vector, const size_t pos, const void *call_site);
+
+static inline void *slot(const vector_t *vector, void *data, const size_t index) {
+    return data + index * vector->element_size;
+}
+
 static inline void *element(const vector_t *vector, const size_t index) {
-    assert(vector && index < vector->size);
-    return vector->data + index * vector->element_size;
+    VECTOR_CHECK(vector && index < vector->size);
+    return slot(vector, vector->data, index);
+}
+
+static void copy_element(const vector_t *vector, void *dst, const void *src) {
+    if (vector->element_funcs.copy) {
+        vector->element_funcs.copy(dst, src);
+    } else {
+        vector_system_memcpy(dst, src, vector->element_size);
+    }
+}
+
+// Move count elements from src to dst within the vector's storage. The ranges may overlap.
+static void relocate_elements(const vector_t *vector, const size_t dst, const size_t src, const size_t count) {
+    if (count == 0) {
+        return;
+    }
+    vector_element_move_func_t move = vector->element_funcs.move;
+    if (!move) {
+        vector_system_memmove(slot(vector, vector->data, dst), slot(vector, vector->data, src), count * vector->element_size);
+    } else if (dst < src) {
+        for (size_t i = 0; i < count; ++i) {
+            move(slot(vector, vector->data, dst + i), slot(vector, vector->data, src + i));
+        }
+    } else {
+        for (size_t i = count; i-- > 0;) {
+            move(slot(vector, vector->data, dst + i), slot(vector, vector->data, src + i));
+        }
+    }
+}
+
+static void destroy_elements(const vector_t *vector, const size_t first, const size_t last) {
+    vector_element_destroy_func_t destroy = vector->element_funcs.destroy;
+    if (destroy) {
+        for (size_t i = first; i < last; ++i) {
+            destroy(slot(vector, vector->data, i));
+        }
+    }
+}
+
+// Try to grow the vector's storage to capacity elements without moving it. The hooks must be the
+// same snapshot used to reallocate the storage, since try_expand only understands blocks from its
+// own realloc.
+static bool expand_storage(vector_t *vector, const size_t capacity, const vector_hooks_t *hooks) {
+    return vector->data && hooks->try_expand && hooks->try_expand(vector->data, vector->element_size * capacity);
+}
+
+// Change the storage to hold exactly capacity elements. Elements are moved with the element move
+// function if there is one, otherwise the allocator is free to relocate them with realloc().
+static void *reallocate_storage(vector_t *vector, const size_t capacity, const vector_hooks_t *hooks) {
+    assert(hooks->realloc && hooks->free);
+    const size_t num_bytes = vector->element_size * capacity;
+    if (!vector->element_funcs.move || vector->size == 0) {
+        return hooks->realloc(vector->data, num_bytes);
+    }
+    void *new_data = hooks->realloc(NULL, num_bytes);
+    if (new_data) {
+        for (size_t i = 0; i < vector->size; ++i) {
+            vector->element_funcs.move(slot(vector, new_data, i), slot(vector, vector->data, i));
+        }
+        hooks->free(vector->data);
+    }
+    return new_data;
 }
 
 vector_t *vector_create(const size_t element_size) {
-    assert(element_size > 0);
-    vector_t *vector = vector_realloc(NULL, sizeof(vector_t));
+    VECTOR_CHECK(element_size > 0);
+    vector_t *vector = vector_system_realloc(NULL, sizeof(vector_t));
     if (vector) {
         vector->element_size = element_size;
         vector->size = 0;
         vector->capacity = 0;
         vector->expansion_factor = 2;
+        vector->element_funcs.copy = NULL;
+        vector->element_funcs.move = NULL;
+        vector->element_funcs.destroy = NULL;
         vector->data = NULL;
     }
     return vector;
@@ -62,113 +134,159 @@ vector_t *vector_create(const size_t element_size) {
 vector_t *vector_create_with_size(const size_t element_size, const size_t size) {
     vector_t *vector = vector_create(element_size);
     if (vector) {
-        vector_resize(vector, size);
+        resize(vector, size, CALL_SITE());
     }
     return vector;
 }
 
 vector_t *vector_create_with_value(const size_t element_size, const size_t count, const void *value) {
-    assert(count == 0 || value);
+    VECTOR_CHECK(count == 0 || value);
     vector_t *vector = vector_create(element_size);
     if (vector) {
-        vector_resize(vector, count);
+        resize(vector, count, CALL_SITE());
         for (size_t i = 0; i < count; ++i) {
-            vector_memcpy(element(vector, i), value, element_size);
+            vector_system_memcpy(element(vector, i), value, element_size);
         }
     }
     return vector;
 }
 
 vector_t *vector_create_with_values(const size_t element_size, const size_t count, const void *values) {
-    assert(count == 0 || values);
+    VECTOR_CHECK(count == 0 || values);
     vector_t *vector = vector_create(element_size);
     if (vector) {
-        vector_resize(vector, count);
-        vector_memcpy(vector->data, values, count * element_size);
+        resize(vector, count, CALL_SITE());
+        vector_system_memcpy(vector->data, values, count * element_size);
     }
     return vector;
 }
 
 vector_t *vector_create_with_vector(const vector_t *other) {
-    assert(other);
+    VECTOR_CHECK(other);
     vector_t *vector = vector_create(other->element_size);
     if (vector) {
-        vector_resize(vector, other->size);
-        vector_memcpy(vector->data, other->data, other->size * other->element_size);
+        vector->expansion_factor = other->expansion_factor;
+        vector->element_funcs = other->element_funcs;
+        reserve(vector, other->size, CALL_SITE());
+        if (vector->element_funcs.copy) {
+            for (size_t i = 0; i < other->size; ++i) {
+                vector->element_funcs.copy(slot(vector, vector->data, i), element(other, i));
+            }
+        } else {
+            vector_system_memcpy(vector->data, other->data, other->size * other->element_size);
+        }
+        vector->size = other->size;
+    }
+    return vector;
+}
+
+vector_t *vector_adopt(const size_t element_size, void *data, const size_t size, const size_t capacity) {
+    VECTOR_CHECK(size <= capacity && (data || capacity == 0));
+    vector_t *vector = vector_create(element_size);
+    if (vector) {
+        vector->data = data;
+        vector->size = size;
+        vector->capacity = capacity;
     }
     return vector;
 }
 
+void *vector_release(vector_t *vector, size_t *size) {
+    VECTOR_CHECK(vector);
+    void *data = vector->data;
+    if (size) {
+        *size = vector->size;
+    }
+    vector_system_free(vector);
+    return data;
+}
+
 void vector_destroy(vector_t *vector) {
-    assert(vector);
-    vector_free(vector);
+    VECTOR_CHECK(vector);
+    destroy_elements(vector, 0, vector->size);
+    vector_system_free(vector->data);
+    vector_system_free(vector);
 }
 
 size_t vector_element_size(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return vector->element_size;
 }
 
 bool vector_empty(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return vector->size == 0;
 }
 
 size_t vector_size(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return vector->size;
 }
 
 size_t vector_max_size(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return VECTOR_MAX_SIZE;
 }
 
 size_t vector_capacity(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return vector->capacity;
 }
 
 void vector_reserve(vector_t *vector, const size_t capacity) {
-    assert(vector);
-    if (vector->capacity < capacity) {
-        void *new_data = vector_realloc(vector->data, vector->element_size * capacity);
-        if (!new_data) {
-            vector_fprintf(stderr, "Could not allocate %u bytes.", vector->element_size * capacity);
-            vector_abort();
+    VECTOR_CHECK(vector);
+    reserve(vector, capacity, CALL_SITE());
+}
+
+void vector_reserve_additional(vector_t *vector, const size_t count) {
+    VECTOR_CHECK(vector && count <= VECTOR_MAX_SIZE - vector->size);
+    if (count <= VECTOR_MAX_SIZE - vector->size) {
+        reserve(vector, vector->size + count, CALL_SITE());
+    }
+}
+
+void vector_shrink_to(vector_t *vector, const size_t capacity) {
+    VECTOR_CHECK(vector);
+    const size_t new_capacity = capacity > vector->size ? capacity : vector->size;
+    if (vector->capacity > new_capacity) {
+        void *new_data = reallocate_storage(vector, new_capacity, vector_get_global_hooks());
+        if (new_capacity > 0 && !new_data) {
+            vector_system_fprintf(stderr, "Could not shrink allocation to %zu elements of %zu bytes.", new_capacity,
+                                  vector->element_size);
+            vector_system_abort();
             return;
         }
         vector->data = new_data;
-        vector->capacity = capacity;
+        vector->capacity = new_capacity;
     }
-    assert(vector->capacity >= capacity);
 }
 
 void vector_clear(vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
+    destroy_elements(vector, 0, vector->size);
     vector->size = 0;
 }
 
 void vector_resize(vector_t *vector, const size_t size) {
-    assert(vector);
-    vector_reserve(vector, size);
-    vector->size = size;
+    VECTOR_CHECK(vector);
+    resize(vector, size, CALL_SITE());
 }
 
-void vector_size_to_fit(vector_t *vector) {
-    assert(vector);
-    if (vector->capacity > vector->size) {
-        size_t num_bytes = vector->size * vector->element_size;
-        void *new_data = vector_realloc(vector->data, num_bytes);
-        if (num_bytes > 0 && !new_data) {
-            vector_fprintf(stderr, "Could not shrink allocation to %u bytes.", num_bytes);
-            vector_abort();
-            return;
-        }
-        vector->data = new_data;
-        vector->capacity = vector->size;
+void vector_resize_default(vector_t *vector, const size_t size, const void *fill) {
+    VECTOR_CHECK(vector && (size <= vector->size || fill));
+    const size_t old_size = vector->size;
+    if (size > old_size && !fill) {
+        return;
+    }
+    resize(vector, size, CALL_SITE());
+    for (size_t i = old_size; i < vector->size; ++i) {
+        copy_element(vector, slot(vector, vector->data, i), fill);
     }
-    assert(vector->capacity == vector->size);
+}
+
+void vector_size_to_fit(vector_t *vector) {
+    VECTOR_CHECK(vector);
+    vector_shrink_to(vector, vector->size);
 }
 
 void *vector_get(const vector_t *vector, const size_t index) {
@@ -176,132 +294,188 @@ void *vector_get(const vector_t *vector, const size_t index) {
 }
 
 void vector_set(vector_t *vector, const size_t index, const void *value) {
-    assert(vector && value && index < vector->size);
-    vector_memcpy(element(vector, index), value, vector->element_size);
+    VECTOR_CHECK(vector && value && index < vector->size);
+    if (index < vector->size) {
+        destroy_elements(vector, index, index + 1);
+        copy_element(vector, element(vector, index), value);
+    }
 }
 
 void *vector_front(const vector_t *vector) {
-    assert(vector && vector->size >= 1);
+    VECTOR_CHECK(vector && vector->size >= 1);
     return vector->data;
 }
 
 void *vector_back(const vector_t *vector) {
-    assert(vector && vector->size >= 1);
+    VECTOR_CHECK(vector && vector->size >= 1);
     return element(vector, vector->size - 1);
 }
 
 void *vector_data(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return vector->data;
 }
 
 void vector_push_back(vector_t *vector, const void* value) {
-    assert(vector && value);
-    const size_t new_capacity = vector_capacity_for_size(vector, ++vector->size);
-    vector_reserve(vector, new_capacity);
-    vector_memcpy(element(vector, vector->size - 1), value, vector->element_size);
+    VECTOR_CHECK(vector && value);
+    void *new_element = emplace_back_n(vector, 1, CALL_SITE());
+    if (new_element) {
+        copy_element(vector, new_element, value);
+    }
+}
+
+void *vector_emplace_back(vector_t *vector) {
+    VECTOR_CHECK(vector);
+    return emplace_back_n(vector, 1, CALL_SITE());
+}
+
+void *vector_emplace_back_n(vector_t *vector, const size_t count) {
+    VECTOR_CHECK(vector && count <= VECTOR_MAX_SIZE - vector->size);
+    return emplace_back_n(vector, count, CALL_SITE());
 }
 
 void vector_pop_back(vector_t *vector) {
-    assert(vector && vector->size >= 1);
+    VECTOR_CHECK(vector && vector->size >= 1);
     if (vector->size > 0) {
+        destroy_elements(vector, vector->size - 1, vector->size);
         --vector->size;
     }
 }
 
 void vector_insert(vector_t *vector, const size_t pos, const void *value) {
-    assert(vector && value && pos <= vector->size);
-    const size_t new_capacity = vector_capacity_for_size(vector, vector->size + 1);
-    vector_reserve(vector, new_capacity);
-    if (pos <= vector->size) {
-        ++vector->size;
-        const size_t byte_count = (vector->size - 1) * vector->element_size;
-        if (byte_count > 0) {
-            vector_memmove(element(vector, pos + 1), element(vector, pos), byte_count);
-        }
-        vector_memcpy(element(vector, pos), value, vector->element_size);
+    VECTOR_CHECK(vector && value && pos <= vector->size);
+    void *new_element = emplace(vector, pos, CALL_SITE());
+    if (new_element) {
+        copy_element(vector, new_element, value);
     }
 }
 
+void *vector_emplace(vector_t *vector, const size_t pos) {
+    VECTOR_CHECK(vector && pos <= vector->size);
+    return emplace(vector, pos, CALL_SITE());
+}
+
 void vector_erase(vector_t *vector, const size_t pos) {
-    assert(vector && pos <= vector->size);
+    VECTOR_CHECK(vector && pos <= vector->size);
     if (pos < vector->size) {
-        const size_t byte_count = (vector->size - 1) * vector->element_size;
-        if (byte_count > 0) {
-            vector_memmove(element(vector, pos), element(vector, pos + 1), byte_count);
-        }
+        destroy_elements(vector, pos, pos + 1);
+        relocate_elements(vector, pos, pos + 1, vector->size - pos - 1);
         --vector->size;
     }
 }
 
 void vector_swap(vector_t *first, vector_t *second) {
-    assert(first && second && first->element_size == second->element_size);
+    VECTOR_CHECK(first && second && first->element_size == second->element_size);
+    if (first->element_size != second->element_size) {
+        return;
+    }
     size_t tmp_size = first->size;
     size_t tmp_capacity = first->capacity;
     float tmp_expansion_factor = first->expansion_factor;
+    vector_element_funcs_t tmp_element_funcs = first->element_funcs;
     void *tmp_data = first->data;
     first->size = second->size;
     first->capacity = second->capacity;
+    first->expansion_factor = second->expansion_factor;
+    first->element_funcs = second->element_funcs;
     first->data = second->data;
     second->size = tmp_size;
     second->capacity = tmp_capacity;
     second->expansion_factor = tmp_expansion_factor;
+    second->element_funcs = tmp_element_funcs;
     second->data = tmp_data;
 }
 
 float vector_expansion_factor(const vector_t *vector) {
-    assert(vector);
+    VECTOR_CHECK(vector);
     return vector->expansion_factor;
 }
 
 void vector_set_expansion_factor(vector_t *vector, const float expansion_factor) {
-    assert(vector && expansion_factor > 1);
+    VECTOR_CHECK(vector && expansion_factor > 1);
     vector->expansion_factor = expansion_factor;
 }
 
-size_t vector_capacity_for_size(const vector_t *vector, const size_t size) {
-    assert(vector);
-    return capacity_for_size(vector->capacity, size, vector->expansion_factor);
+const vector_element_funcs_t *vector_element_funcs(const vector_t *vector) {
+    VECTOR_CHECK(vector);
+    return &vector->element_funcs;
 }
 
-static void vector_abort(const vector_t *vector) {
-    vector_abort_func_t abort_func = vector_get_global_abort_func();
-    assert(abort_func);
-    abort_func();
+void vector_set_element_funcs(vector_t *vector, const vector_element_funcs_t *element_funcs) {
+    VECTOR_CHECK(vector);
+    if (element_funcs) {
+        vector->element_funcs = *element_funcs;
+    } else {
+        vector->element_funcs.copy = NULL;
+        vector->element_funcs.move = NULL;
+        vector->element_funcs.destroy = NULL;
+    }
 }
 
-static void vector_free(void *ptr) {
-    vector_free_func_t free_func = vector_get_global_free_func();
-    assert(free_func);
-    free_func(ptr);
+size_t vector_capacity_for_size(const vector_t *vector, const size_t size) {
+    VECTOR_CHECK(vector);
+    return capacity_for_size(vector->capacity, size, vector->expansion_factor);
 }
 
-static void *vector_memcpy(void *restrict dst, const void *restrict src, size_t n) {
-    vector_memcpy_func_t memcpy_func = vector_get_global_memcpy_func();
-    assert(memcpy_func);
-    return memcpy_func(dst, src, n);
+static void reserve(vector_t *vector, const size_t capacity, const void *call_site) {
+    if (vector->capacity < capacity) {
+        // Fetch all hooks with one load so that a concurrent change cannot mix functions from two sets.
+        const vector_hooks_t *hooks = vector_get_global_hooks();
+        if (!expand_storage(vector, capacity, hooks)) {
+            void *new_data = reallocate_storage(vector, capacity, hooks);
+            if (!new_data) {
+                vector_system_fprintf(stderr, "Could not allocate %zu elements of %zu bytes.", capacity, vector->element_size);
+                vector_system_abort();
+                return;
+            }
+            vector->data = new_data;
+        }
+        const size_t old_capacity = vector->capacity;
+        vector->capacity = capacity;
+
+        if (hooks->grow) {
+            hooks->grow(vector, call_site, old_capacity, capacity);
+        }
+    }
+    assert(vector->capacity >= capacity);
 }
 
-static void *vector_memmove(void *dst, const void *src, size_t len) {
-    vector_memmove_func_t memmove_func = vector_get_global_memmove_func();
-    assert(memmove_func);
-    return memmove_func(dst, src, len);
+static void resize(vector_t *vector, const size_t size, const void *call_site) {
+    if (size < vector->size) {
+        destroy_elements(vector, size, vector->size);
+    }
+    reserve(vector, size, call_site);
+    if (vector->capacity >= size) {
+        vector->size = size;
+    }
 }
 
-static void *vector_realloc(void *ptr, const size_t size) {
-    vector_realloc_func_t realloc_func = vector_get_global_realloc_func();
-    assert(realloc_func);
-    return realloc_func(ptr, size);
+static void *emplace_back_n(vector_t *vector, const size_t count, const void *call_site) {
+    if (count > VECTOR_MAX_SIZE - vector->size) {
+        return NULL;
+    }
+    const size_t new_size = vector->size + count;
+    reserve(vector, vector_capacity_for_size(vector, new_size), call_site);
+    if (vector->capacity < new_size) {
+        return NULL;
+    }
+    void *first_new_element = slot(vector, vector->data, vector->size);
+    vector->size = new_size;
+    return first_new_element;
 }
 
-static void vector_fprintf(FILE * restrict stream, const char * restrict format, ...) {
-    vector_vfprintf_func_t vfprintf_func = vector_get_global_vfprintf_func();
-    if (vfprintf_func) {
-        va_list arg_pointers;
-        va_start(arg_pointers, format);
-        vfprintf_func(stream, format, arg_pointers);
-        va_end(arg_pointers); 
+static void *emplace(vector_t *vector, const size_t pos, const void *call_site) {
+    if (pos > vector->size) {
+        return NULL;
     }
+    reserve(vector, vector_capacity_for_size(vector, vector->size + 1), call_site);
+    if (vector->capacity <= vector->size) {
+        return NULL;
+    }
+    const size_t count = vector->size - pos;
+    ++vector->size;
+    relocate_elements(vector, pos + 1, pos, count);
+    return element(vector, pos);
 }
 
 // TODO: Expose this as an advanced global function the user can replace.
@@ -330,4 +504,3 @@ static size_t capacity_for_size(const size_t cur_capacity,
     return cur_capacity >= required_size ? cur_capacity : required_size;
 }
 #endif
-
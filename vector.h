@@ -34,6 +34,31 @@ struct vector_t;
 /** An array of fixed-sized members that can grow at runtime, similar to C++'s std::vector. */
 typedef struct vector_t vector_t;
 
+/** A function that initializes the element at @c dst as a copy of the element at @c src. */
+typedef void (*vector_element_copy_func_t)(void *dst, const void *src);
+
+/**
+ A function that initializes the element at @c dst from the element at @c src, leaving @c src as
+ uninitialized storage that will not be destroyed.
+ */
+typedef void (*vector_element_move_func_t)(void *dst, void *src);
+
+/** A function that releases any resources owned by an element. */
+typedef void (*vector_element_destroy_func_t)(void *element);
+
+/**
+ Optional functions for elements that own resources, e.g. structures with heap-allocated members.
+
+ Any of the functions may be NULL. Without a copy function elements are copied with memcpy(),
+ without a move function they are relocated with memmove() or realloc(), and without a destroy
+ function removing an element does nothing.
+ */
+typedef struct vector_element_funcs_t {
+    vector_element_copy_func_t copy;
+    vector_element_move_func_t move;
+    vector_element_destroy_func_t destroy;
+} vector_element_funcs_t;
+
 /**
  Create an empty vector.
 
@@ -82,15 +107,49 @@ VECTOR_EXTERN vector_t *vector_create_with_values(const size_t element_size, con
 /**
  Create a vector by copying another vector.
 
+ The new vector uses the element functions of @c other, so elements are copied with its copy
+ function if there is one.
+
  @param other The vector to copy.
 
  @return A new intialized vector copy of @c other.
  */
 VECTOR_EXTERN vector_t *vector_create_with_vector(const vector_t *other);
 
+/**
+ Create a vector that takes ownership of an existing buffer without copying it.
+
+ The buffer must have been allocated with the library's realloc() function (see
+ @c vector_get_global_realloc_func()), which by default is the system realloc(), so that the vector
+ can grow and free it. If creating the vector fails, the caller keeps ownership of the buffer.
+
+ @param element_size The size of each element in bytes.
+ @param data         A buffer with room for @c capacity elements, or @c NULL if @c capacity is zero.
+ @param size         The number of initialized elements at the start of the buffer.
+ @param capacity     The number of elements the buffer has room for, at least @c size.
+
+ @return A new vector using @c data as its storage, or @c NULL if the vector could not be allocated.
+ */
+VECTOR_EXTERN vector_t *vector_adopt(const size_t element_size, void *data, const size_t size, const size_t capacity);
+
+/**
+ Destroy a vector but keep its storage, returning ownership of it to the caller.
+
+ The elements are not destroyed. The returned buffer must be freed with the library's free()
+ function (see @c vector_get_global_free_func()), which by default is the system free().
+
+ @param vector A vector.
+ @param size   If not @c NULL, set to the number of elements in the returned buffer.
+
+ @return The vector's storage, or @c NULL if it had none.
+ */
+VECTOR_EXTERN void *vector_release(vector_t *vector, size_t *size);
+
 /**
  Destroy a vector and deallocate its memory.
 
+ The elements are destroyed with the vector's destroy function first if there is one.
+
  @param vector A vector.
  */
 VECTOR_EXTERN void vector_destroy(vector_t *vector);
@@ -156,9 +215,39 @@ VECTOR_EXTERN size_t vector_capacity(const vector_t *vector);
  */
 VECTOR_EXTERN void vector_reserve(vector_t *vector, const size_t capacity);
 
+/**
+ Ensure that @c count more elements can be appended to a vector without reallocation.
+
+ Unlike growth from appending elements, the capacity is not rounded up by the expansion factor: if
+ the vector must grow, its new capacity is exactly its size plus @c count. Callers that know roughly
+ how many elements they are about to append can use this to avoid both intermediate reallocations
+ and overshoot. If memory allocation fails, the global handler returned by
+ @c vector_get_global_abort_func() is called.
+
+ Invalidates element pointers if the vector's storage grows.
+
+ @param vector A vector.
+ @param count  The number of elements that will be appended.
+ */
+VECTOR_EXTERN void vector_reserve_additional(vector_t *vector, const size_t count);
+
+/**
+ Reduce a vector's capacity to @c capacity, or to its size if that is larger.
+
+ Does nothing if the vector's capacity is already at most @c capacity.
+
+ Invalidates element pointers if the capacity changes.
+
+ @param vector   A vector.
+ @param capacity The new capacity.
+ */
+VECTOR_EXTERN void vector_shrink_to(vector_t *vector, const size_t capacity);
+
 /**
  Remove all elements from a vector.
 
+ The elements are destroyed with the vector's destroy function if there is one.
+
  Invalidates element pointers.
 
  @param vector A vector.
@@ -168,7 +257,9 @@ VECTOR_EXTERN void vector_clear(vector_t *vector);
 /**
  Resize a vector.
  
- If @c size is greater than the vector's current size, the new elements will be uninitialized.
+ If @c size is greater than the vector's current size, the new elements will be uninitialized. If
+ it is smaller, the removed elements are destroyed with the vector's destroy function if there is
+ one.
  
  Invalidates element pointers if @c size is greater than the current capacity.
 
@@ -177,6 +268,20 @@ VECTOR_EXTERN void vector_clear(vector_t *vector);
  */
 VECTOR_EXTERN void vector_resize(vector_t *vector, const size_t size);
 
+/**
+ Resize a vector, initializing new elements to a value.
+
+ Like @c vector_resize(), except that if @c size is greater than the vector's current size, each new
+ element is a copy of @c fill, made with the vector's copy function if there is one.
+
+ Invalidates element pointers if @c size is greater than the current capacity.
+
+ @param vector A vector.
+ @param size   The new size.
+ @param fill   A pointer to the value of the new elements. May be @c NULL if the vector does not grow.
+ */
+VECTOR_EXTERN void vector_resize_default(vector_t *vector, const size_t size, const void *fill);
+
 /**
  Resize the a vector's internal storage to fit its size.
  
@@ -201,6 +306,9 @@ VECTOR_EXTERN void *vector_get(const vector_t *vector, const size_t index);
 /**
  Set an element of a vector.
 
+ The previous element is destroyed and the new one copied from @c value with the vector's element
+ functions if there are any, so @c value must not point to the element being replaced.
+
  @param vector A vector.
  @param index  An index in the range of [0, size - 1].
  @param value  A pointer to the new value of at least @c member_size bytes.
@@ -248,9 +356,40 @@ VECTOR_EXTERN void *vector_data(const vector_t *vector);
  */
 VECTOR_EXTERN void vector_push_back(vector_t *vector, const void* value);
 
+/**
+ Append an uninitialized element to a vector, increasing its size by one.
+
+ The caller constructs the new element in place through the returned pointer, which avoids building
+ the value elsewhere and copying it in.
+
+ Invalidates element pointers if the current size plus one is greater than the capacity.
+
+ @param vector A vector.
+
+ @return A pointer to the new, uninitialized last element, or NULL if allocation failed.
+ */
+VECTOR_EXTERN void *vector_emplace_back(vector_t *vector);
+
+/**
+ Append @c count uninitialized elements to a vector, increasing its size by @c count.
+
+ The new elements are contiguous, so the caller can construct them in a single pass through the
+ returned pointer.
+
+ Invalidates element pointers if the current size plus @c count is greater than the capacity.
+
+ @param vector A vector.
+ @param count  The number of elements to append.
+
+ @return A pointer to the first new, uninitialized element, or NULL if allocation failed.
+ */
+VECTOR_EXTERN void *vector_emplace_back_n(vector_t *vector, const size_t count);
+
 /**
  Remove the last element of a vector, decreasing its size by one.
 
+ The element is destroyed with the vector's destroy function if there is one.
+
  @param vector A vector.
  */
 VECTOR_EXTERN void vector_pop_back(vector_t *vector);
@@ -268,9 +407,26 @@ VECTOR_EXTERN void vector_pop_back(vector_t *vector);
  */
 VECTOR_EXTERN void vector_insert(vector_t *vector, const size_t pos, const void *value);
 
+/**
+ Insert an uninitialized element into a vector.
+
+ Elements with positions greater than or equal to @c pos will be shifted to make room for the new
+ element, which the caller constructs in place through the returned pointer.
+
+ Invalidates element pointers.
+
+ @param vector A vector.
+ @param pos    The index of the new element.
+
+ @return A pointer to the new, uninitialized element, or NULL if allocation failed.
+ */
+VECTOR_EXTERN void *vector_emplace(vector_t *vector, const size_t pos);
+
 /**
  Erase an element of a vector, decreasing its size by one.
 
+ The element is destroyed with the vector's destroy function if there is one.
+
  @param vector A vector.
  @param pos    The index of the element to erase.
  */
@@ -279,7 +435,8 @@ VECTOR_EXTERN void vector_erase(vector_t *vector, const size_t pos);
 /**
  Swap the contents of two vectors.
  
- The contents are swapped with no copying or reallocation.
+ The contents, expansion factors and element functions are swapped with no copying or
+ reallocation.
  
  Element pointers are not invalidated, but will point to the swapped contents.
 
@@ -314,6 +471,30 @@ VECTOR_EXTERN float vector_expansion_factor(const vector_t *vector);
  */
 VECTOR_EXTERN void vector_set_expansion_factor(vector_t *vector, const float expansion_factor);
 
+/**
+ Return the element functions of a vector.
+
+ @param vector A vector.
+
+ @return The vector's element functions. Unset functions are NULL.
+ */
+VECTOR_EXTERN const vector_element_funcs_t *vector_element_funcs(const vector_t *vector);
+
+/**
+ Set the element functions of a vector.
+
+ The copy function is used whenever the library copies an element from a value or another vector,
+ the move function whenever it relocates elements during growth, shrinking, insertion or erasure,
+ and the destroy function whenever an element is removed or the vector is destroyed. Elements
+ constructed through the emplace functions are owned by the vector as if they had been copied in.
+
+ The functions should be set while the vector is empty.
+
+ @param vector        A vector.
+ @param element_funcs The new element functions, or NULL to restore the default behavior.
+ */
+VECTOR_EXTERN void vector_set_element_funcs(vector_t *vector, const vector_element_funcs_t *element_funcs);
+
 /**
  Return the capacity that would be used for a particular size.
  
@@ -0,0 +1,58 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_ATOMIC_H
+#define VECTOR_ATOMIC_H
+
+/**
+ @file vector_atomic.h
+
+ Atomic operations used by the library's implementation (internal).
+
+ C99 has no atomics, so these wrap the GCC and clang @c __atomic builtins. Each macro takes a
+ pointer to a naturally aligned integer or pointer object. Other compilers fall back to plain
+ accesses, which are only safe if the library is configured before any threads start.
+ */
+
+#include <stdbool.h>
+
+#if defined(__GNUC__)
+#   define VECTOR_ATOMIC_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#   define VECTOR_ATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#   define VECTOR_ATOMIC_STORE_RELAXED(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#   define VECTOR_ATOMIC_STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#   define VECTOR_ATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#   define VECTOR_ATOMIC_FETCH_SUB(ptr, value) __atomic_fetch_sub((ptr), (value), __ATOMIC_ACQ_REL)
+#   define VECTOR_ATOMIC_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#   define VECTOR_ATOMIC_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#   define VECTOR_ATOMIC_FENCE_SEQ_CST() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#   define VECTOR_ATOMIC_COMPARE_EXCHANGE(ptr, expected, desired) \
+        __atomic_compare_exchange_n((ptr), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#   define VECTOR_ATOMIC_LOAD_RELAXED(ptr) (*(ptr))
+#   define VECTOR_ATOMIC_LOAD_ACQUIRE(ptr) VECTOR_ATOMIC_LOAD_RELAXED(ptr)
+#   define VECTOR_ATOMIC_STORE_RELAXED(ptr, value) ((void)(*(ptr) = (value)))
+#   define VECTOR_ATOMIC_STORE_RELEASE(ptr, value) VECTOR_ATOMIC_STORE_RELAXED(ptr, value)
+#   define VECTOR_ATOMIC_FETCH_ADD(ptr, value) ((*(ptr) += (value)) - (value))
+#   define VECTOR_ATOMIC_FETCH_SUB(ptr, value) ((*(ptr) -= (value)) + (value))
+#   define VECTOR_ATOMIC_FENCE_ACQUIRE() ((void)0)
+#   define VECTOR_ATOMIC_FENCE_RELEASE() ((void)0)
+#   define VECTOR_ATOMIC_FENCE_SEQ_CST() ((void)0)
+#   define VECTOR_ATOMIC_COMPARE_EXCHANGE(ptr, expected, desired) \
+        (*(ptr) == *(expected) ? (*(ptr) = (desired), true) : (*(expected) = *(ptr), false))
+#endif
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_bit.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+
+static const size_t WORD_BITS = 64;
+
+// The words are stored in a plain vector so that all allocation goes through the global system
+// functions. Bits past size in the last word are kept at zero.
+struct bitvector_t {
+    vector_t *words;
+    size_t size;
+};
+
+static inline size_t words_for_bits(const size_t bits) {
+    return bits / WORD_BITS + (bits % WORD_BITS != 0);
+}
+
+static inline uint64_t *word_data(const bitvector_t *bitvector) {
+    return vector_data(bitvector->words);
+}
+
+static inline size_t popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & UINT64_C(0x5555555555555555));
+    word = (word & UINT64_C(0x3333333333333333)) + ((word >> 2) & UINT64_C(0x3333333333333333));
+    word = (word + (word >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    return (size_t)((word * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+static inline size_t count_trailing_zeros64(const uint64_t word) {
+    assert(word != 0);
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(word);
+#else
+    size_t count = 0;
+    while (!(word & ((uint64_t)1 << count))) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Zero the bits of the last word past the size.
+static void clear_unused_bits(bitvector_t *bitvector) {
+    const size_t used = bitvector->size % WORD_BITS;
+    if (used != 0) {
+        word_data(bitvector)[bitvector->size / WORD_BITS] &= ((uint64_t)1 << used) - 1;
+    }
+}
+
+bitvector_t *bitvector_create(void) {
+    bitvector_t *bitvector = vector_system_realloc(NULL, sizeof(bitvector_t));
+    if (bitvector) {
+        bitvector->words = vector_create(sizeof(uint64_t));
+        if (!bitvector->words) {
+            vector_system_free(bitvector);
+            return NULL;
+        }
+        bitvector->size = 0;
+    }
+    return bitvector;
+}
+
+bitvector_t *bitvector_create_with_size(const size_t size, const bool value) {
+    bitvector_t *bitvector = bitvector_create();
+    if (bitvector) {
+        bitvector_resize(bitvector, size);
+        if (value) {
+            uint64_t *words = word_data(bitvector);
+            for (size_t i = 0; i < vector_size(bitvector->words); ++i) {
+                words[i] = ~(uint64_t)0;
+            }
+            clear_unused_bits(bitvector);
+        }
+    }
+    return bitvector;
+}
+
+void bitvector_destroy(bitvector_t *bitvector) {
+    VECTOR_CHECK(bitvector);
+    vector_destroy(bitvector->words);
+    vector_system_free(bitvector);
+}
+
+bool bitvector_empty(const bitvector_t *bitvector) {
+    VECTOR_CHECK(bitvector);
+    return bitvector->size == 0;
+}
+
+size_t bitvector_size(const bitvector_t *bitvector) {
+    VECTOR_CHECK(bitvector);
+    return bitvector->size;
+}
+
+void bitvector_reserve(bitvector_t *bitvector, const size_t capacity) {
+    VECTOR_CHECK(bitvector);
+    vector_reserve(bitvector->words, words_for_bits(capacity));
+}
+
+void bitvector_clear(bitvector_t *bitvector) {
+    VECTOR_CHECK(bitvector);
+    vector_clear(bitvector->words);
+    bitvector->size = 0;
+}
+
+void bitvector_resize(bitvector_t *bitvector, const size_t size) {
+    VECTOR_CHECK(bitvector);
+    const size_t old_words = vector_size(bitvector->words);
+    const size_t new_words = words_for_bits(size);
+    vector_resize(bitvector->words, new_words);
+    uint64_t *words = word_data(bitvector);
+    for (size_t i = old_words; i < new_words; ++i) {
+        words[i] = 0;
+    }
+    bitvector->size = size;
+    clear_unused_bits(bitvector);
+}
+
+bool bitvector_get(const bitvector_t *bitvector, const size_t index) {
+    VECTOR_CHECK(bitvector && index < bitvector->size);
+    return (word_data(bitvector)[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+void bitvector_set(bitvector_t *bitvector, const size_t index, const bool value) {
+    VECTOR_CHECK(bitvector && index < bitvector->size);
+    uint64_t *word = &word_data(bitvector)[index / WORD_BITS];
+    const uint64_t mask = (uint64_t)1 << (index % WORD_BITS);
+    *word = value ? (*word | mask) : (*word & ~mask);
+}
+
+void bitvector_push_back(bitvector_t *bitvector, const bool value) {
+    VECTOR_CHECK(bitvector);
+    if (bitvector->size % WORD_BITS == 0) {
+        uint64_t *word = vector_emplace_back(bitvector->words);
+        if (!word) {
+            return;
+        }
+        *word = 0;
+    }
+    ++bitvector->size;
+    if (value) {
+        bitvector_set(bitvector, bitvector->size - 1, true);
+    }
+}
+
+size_t bitvector_popcount(const bitvector_t *bitvector) {
+    VECTOR_CHECK(bitvector);
+    const uint64_t *words = word_data(bitvector);
+    const size_t num_words = vector_size(bitvector->words);
+    size_t count = 0;
+    for (size_t i = 0; i < num_words; ++i) {
+        count += popcount64(words[i]);
+    }
+    return count;
+}
+
+size_t bitvector_find_first_set(const bitvector_t *bitvector, const size_t from) {
+    VECTOR_CHECK(bitvector && from <= bitvector->size);
+    if (from >= bitvector->size) {
+        return bitvector->size;
+    }
+    const uint64_t *words = word_data(bitvector);
+    const size_t num_words = vector_size(bitvector->words);
+    size_t i = from / WORD_BITS;
+    uint64_t word = words[i] & (~(uint64_t)0 << (from % WORD_BITS));
+    while (word == 0) {
+        if (++i == num_words) {
+            return bitvector->size;
+        }
+        word = words[i];
+    }
+    return i * WORD_BITS + count_trailing_zeros64(word);
+}
+
+void bitvector_and(bitvector_t *dst, const bitvector_t *src) {
+    VECTOR_CHECK(dst && src && dst->size == src->size);
+    if (dst->size != src->size) {
+        return;
+    }
+    uint64_t *d = word_data(dst);
+    const uint64_t *s = word_data(src);
+    const size_t num_words = vector_size(dst->words);
+    for (size_t i = 0; i < num_words; ++i) {
+        d[i] &= s[i];
+    }
+}
+
+void bitvector_or(bitvector_t *dst, const bitvector_t *src) {
+    VECTOR_CHECK(dst && src && dst->size == src->size);
+    if (dst->size != src->size) {
+        return;
+    }
+    uint64_t *d = word_data(dst);
+    const uint64_t *s = word_data(src);
+    const size_t num_words = vector_size(dst->words);
+    for (size_t i = 0; i < num_words; ++i) {
+        d[i] |= s[i];
+    }
+}
+
+void bitvector_xor(bitvector_t *dst, const bitvector_t *src) {
+    VECTOR_CHECK(dst && src && dst->size == src->size);
+    if (dst->size != src->size) {
+        return;
+    }
+    uint64_t *d = word_data(dst);
+    const uint64_t *s = word_data(src);
+    const size_t num_words = vector_size(dst->words);
+    for (size_t i = 0; i < num_words; ++i) {
+        d[i] ^= s[i];
+    }
+}
+
+uint64_t *bitvector_words(const bitvector_t *bitvector) {
+    VECTOR_CHECK(bitvector);
+    return word_data(bitvector);
+}
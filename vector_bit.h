@@ -0,0 +1,189 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_BIT_H
+#define VECTOR_BIT_H
+
+/**
+ @file vector_bit.h
+
+ A variable-length array of bits (optional).
+
+ A @c vector_t element is at least one byte, so a vector of flags uses eight times more memory
+ than necessary. A @c bitvector_t packs its elements into 64-bit words and provides word-parallel
+ operations over them.
+ */
+
+#include <stdint.h>
+
+#include "vector.h"
+
+/** An anonymous structure for storing a bit vector's state. */
+struct bitvector_t;
+
+/** An array of bits that can grow at runtime, similar to C++'s std::vector<bool>. */
+typedef struct bitvector_t bitvector_t;
+
+/**
+ Create an empty bit vector.
+
+ @return A new initialized bit vector.
+ */
+VECTOR_EXTERN bitvector_t *bitvector_create(void);
+
+/**
+ Create a bit vector of @c size copies of @c value.
+
+ @param size  The number of bits.
+ @param value The value of every bit.
+
+ @return A new initialized bit vector of size @c size.
+ */
+VECTOR_EXTERN bitvector_t *bitvector_create_with_size(const size_t size, const bool value);
+
+/**
+ Destroy a bit vector and deallocate its memory.
+
+ @param bitvector A bit vector.
+ */
+VECTOR_EXTERN void bitvector_destroy(bitvector_t *bitvector);
+
+/**
+ Return if a bit vector is empty.
+
+ @param bitvector A bit vector.
+
+ @return True if the bit vector has no bits.
+ */
+VECTOR_EXTERN bool bitvector_empty(const bitvector_t *bitvector);
+
+/**
+ Return the number of bits in a bit vector.
+
+ @param bitvector A bit vector.
+
+ @return The size of the bit vector in bits.
+ */
+VECTOR_EXTERN size_t bitvector_size(const bitvector_t *bitvector);
+
+/**
+ Ensure that a bit vector can grow to at least @c capacity bits without reallocation.
+
+ @param bitvector A bit vector.
+ @param capacity  The new capacity in bits.
+ */
+VECTOR_EXTERN void bitvector_reserve(bitvector_t *bitvector, const size_t capacity);
+
+/**
+ Remove all bits from a bit vector.
+
+ @param bitvector A bit vector.
+ */
+VECTOR_EXTERN void bitvector_clear(bitvector_t *bitvector);
+
+/**
+ Resize a bit vector.
+
+ Unlike @c vector_resize(), new bits are initialized to zero.
+
+ @param bitvector A bit vector.
+ @param size      The new size in bits.
+ */
+VECTOR_EXTERN void bitvector_resize(bitvector_t *bitvector, const size_t size);
+
+/**
+ Get a bit.
+
+ @param bitvector A bit vector.
+ @param index     An index in the range of [0, size - 1].
+
+ @return The value of the bit.
+ */
+VECTOR_EXTERN bool bitvector_get(const bitvector_t *bitvector, const size_t index);
+
+/**
+ Set a bit.
+
+ @param bitvector A bit vector.
+ @param index     An index in the range of [0, size - 1].
+ @param value     The new value of the bit.
+ */
+VECTOR_EXTERN void bitvector_set(bitvector_t *bitvector, const size_t index, const bool value);
+
+/**
+ Append a bit, increasing the size by one.
+
+ @param bitvector A bit vector.
+ @param value     The value of the new bit.
+ */
+VECTOR_EXTERN void bitvector_push_back(bitvector_t *bitvector, const bool value);
+
+/**
+ Count the set bits of a bit vector.
+
+ @param bitvector A bit vector.
+
+ @return The number of bits that are one.
+ */
+VECTOR_EXTERN size_t bitvector_popcount(const bitvector_t *bitvector);
+
+/**
+ Find the first set bit at or after an index.
+
+ @param bitvector A bit vector.
+ @param from      The index to start searching at, in the range of [0, size].
+
+ @return The index of the first set bit at or after @c from, or the size if there is none.
+ */
+VECTOR_EXTERN size_t bitvector_find_first_set(const bitvector_t *bitvector, const size_t from);
+
+/**
+ Replace a bit vector with the bitwise AND of itself and another bit vector of the same size.
+
+ @param dst A bit vector.
+ @param src A bit vector with the same size as @c dst.
+ */
+VECTOR_EXTERN void bitvector_and(bitvector_t *dst, const bitvector_t *src);
+
+/**
+ Replace a bit vector with the bitwise OR of itself and another bit vector of the same size.
+
+ @param dst A bit vector.
+ @param src A bit vector with the same size as @c dst.
+ */
+VECTOR_EXTERN void bitvector_or(bitvector_t *dst, const bitvector_t *src);
+
+/**
+ Replace a bit vector with the bitwise XOR of itself and another bit vector of the same size.
+
+ @param dst A bit vector.
+ @param src A bit vector with the same size as @c dst.
+ */
+VECTOR_EXTERN void bitvector_xor(bitvector_t *dst, const bitvector_t *src);
+
+/**
+ Return a pointer to a bit vector's storage.
+
+ Bit @c i is bit <tt>i % 64</tt> of word <tt>i / 64</tt>. Bits past the size in the last word are
+ always zero. The returned pointer is valid until a reallocation occurs.
+
+ @param bitvector A bit vector.
+
+ @return A pointer to <tt>(size + 63) / 64</tt> words.
+ */
+VECTOR_EXTERN uint64_t *bitvector_words(const bitvector_t *bitvector);
+
+#endif
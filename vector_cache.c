@@ -0,0 +1,167 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The capacity classes are the powers of two from 2^MIN_CLASS_SHIFT bytes to VECTOR_CACHE_MAX_BYTES.
+#define MIN_CLASS_SHIFT 6
+#define MAX_CLASS_SHIFT 20
+#define NUM_CLASSES (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+
+// Every allocation starts with a header holding its usable capacity. The union keeps the memory
+// that follows it aligned as well as the system allocator aligns it.
+typedef union header_t {
+    size_t capacity;
+    long double align_long_double;
+    long long align_long_long;
+    void *align_pointer;
+} header_t;
+
+// A cached allocation's memory holds the next allocation in its free list.
+typedef struct free_node_t {
+    struct free_node_t *next;
+} free_node_t;
+
+typedef struct thread_cache_t {
+    free_node_t *free_lists[NUM_CLASSES];
+    size_t counts[NUM_CLASSES];
+} thread_cache_t;
+
+static VECTOR_THREAD_LOCAL thread_cache_t thread_cache;
+
+static inline header_t *header(void *ptr) {
+    return (header_t *)ptr - 1;
+}
+
+// The class of an allocation of size bytes, or NUM_CLASSES if it is too large to cache.
+static size_t class_for_size(const size_t size) {
+    if (size > VECTOR_CACHE_MAX_BYTES) {
+        return NUM_CLASSES;
+    }
+    size_t class_index = 0;
+    while (((size_t)1 << (MIN_CLASS_SHIFT + class_index)) < size) {
+        ++class_index;
+    }
+    return class_index;
+}
+
+static inline size_t class_capacity(const size_t class_index) {
+    return (size_t)1 << (MIN_CLASS_SHIFT + class_index);
+}
+
+static inline size_t capacity_for_size(const size_t size) {
+    const size_t class_index = class_for_size(size);
+    return class_index < NUM_CLASSES ? class_capacity(class_index) : size;
+}
+
+static void *allocate(const size_t size) {
+    const size_t class_index = class_for_size(size);
+    if (class_index < NUM_CLASSES && thread_cache.free_lists[class_index]) {
+        free_node_t *node = thread_cache.free_lists[class_index];
+        thread_cache.free_lists[class_index] = node->next;
+        --thread_cache.counts[class_index];
+        return node;
+    }
+
+    const size_t capacity = capacity_for_size(size);
+    if (capacity > (size_t)-1 - sizeof(header_t)) {
+        return NULL;
+    }
+    header_t *block = malloc(sizeof(header_t) + capacity);
+    if (!block) {
+        return NULL;
+    }
+    block->capacity = capacity;
+    return block + 1;
+}
+
+void *vector_cache_realloc_func(void *ptr, size_t size) {
+    if (size == 0) {
+        vector_cache_free_func(ptr);
+        return NULL;
+    }
+    if (!ptr) {
+        return allocate(size);
+    }
+
+    const size_t old_capacity = header(ptr)->capacity;
+    const size_t new_capacity = capacity_for_size(size);
+    if (new_capacity == old_capacity) {
+        return ptr;
+    }
+    if (old_capacity > VECTOR_CACHE_MAX_BYTES && new_capacity > VECTOR_CACHE_MAX_BYTES) {
+        if (new_capacity > (size_t)-1 - sizeof(header_t)) {
+            return NULL;
+        }
+        header_t *block = realloc(header(ptr), sizeof(header_t) + new_capacity);
+        if (!block) {
+            return NULL;
+        }
+        block->capacity = new_capacity;
+        return block + 1;
+    }
+
+    void *new_ptr = allocate(size);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, old_capacity < size ? old_capacity : size);
+        vector_cache_free_func(ptr);
+    }
+    return new_ptr;
+}
+
+bool vector_cache_try_expand_func(void *ptr, size_t size) {
+    return header(ptr)->capacity >= size;
+}
+
+void vector_cache_free_func(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    const size_t capacity = header(ptr)->capacity;
+    const size_t class_index = class_for_size(capacity);
+    if (class_index < NUM_CLASSES && thread_cache.counts[class_index] < VECTOR_CACHE_DEPTH) {
+        free_node_t *node = ptr;
+        node->next = thread_cache.free_lists[class_index];
+        thread_cache.free_lists[class_index] = node;
+        ++thread_cache.counts[class_index];
+        return;
+    }
+    free(header(ptr));
+}
+
+void vector_cache_flush(void) {
+    for (size_t i = 0; i < NUM_CLASSES; ++i) {
+        free_node_t *node = thread_cache.free_lists[i];
+        while (node) {
+            free_node_t *next = node->next;
+            free(header(node));
+            node = next;
+        }
+        thread_cache.free_lists[i] = NULL;
+        thread_cache.counts[i] = 0;
+    }
+}
+
+size_t vector_cache_count(void) {
+    size_t count = 0;
+    for (size_t i = 0; i < NUM_CLASSES; ++i) {
+        count += thread_cache.counts[i];
+    }
+    return count;
+}
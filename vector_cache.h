@@ -0,0 +1,107 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_CACHE_H
+#define VECTOR_CACHE_H
+
+/**
+ @file vector_cache.h
+
+ A thread-local cache of freed allocations (optional).
+
+ Programs that repeatedly create and destroy short-lived vectors on many threads can spend much of
+ their time contending for the system allocator's locks. The functions in this file implement the
+ library's realloc() and free() functions with a small per-thread cache in front of the system
+ allocator: allocations are rounded up to a power-of-two capacity class, and a freed allocation is
+ kept on its thread's free list for that class, to be handed back by the next allocation of the
+ same class on the same thread without calling the system allocator.
+
+ To use the cache, install its functions before the library allocates anything:
+
+ @code
+ vector_set_global_realloc_func(vector_cache_realloc_func);
+ vector_set_global_free_func(vector_cache_free_func);
+ vector_set_global_try_expand_func(vector_cache_try_expand_func);
+ @endcode
+
+ Memory allocated by one pair of functions must not be reallocated or freed by another, so the
+ functions must stay installed while any vector allocated through them exists. To install them
+ together while other threads are running, use vector_set_global_hooks(). Allocations freed on
+ a thread other than the one that allocated them are cached by the freeing thread. The cache keeps
+ at most @c VECTOR_CACHE_DEPTH allocations of each class up to @c VECTOR_CACHE_MAX_BYTES; larger
+ allocations go straight to the system allocator. A thread's cached allocations are not released
+ when the thread exits, so call vector_cache_flush() before a thread that used the cache exits.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector_environment.h"
+
+/** The maximum number of freed allocations cached for each capacity class on each thread. */
+#define VECTOR_CACHE_DEPTH 8
+
+/** The largest allocation, in bytes, that is cached. Must match the classes in vector_cache.c. */
+#define VECTOR_CACHE_MAX_BYTES ((size_t)1 << 20)
+
+/**
+ A realloc() function that allocates through the calling thread's cache.
+
+ Suitable for vector_set_global_realloc_func(). Allocating with a @c NULL @p ptr takes a cached
+ allocation of the right class if there is one. Growing an allocation within its class returns it
+ unchanged. Reallocating to zero bytes frees the allocation and returns @c NULL.
+
+ @param ptr  An allocation from this function, or @c NULL.
+ @param size The requested size in bytes.
+ @return The allocation, or @c NULL if the allocation failed or @p size is zero.
+ */
+VECTOR_EXTERN void *vector_cache_realloc_func(void *ptr, size_t size);
+
+/**
+ A try-expand function for allocations from vector_cache_realloc_func().
+
+ Suitable for vector_set_global_try_expand_func(). Succeeds if the allocation's capacity class
+ already holds @p size bytes, so a vector grows within its class without reallocating.
+
+ @param ptr  An allocation from vector_cache_realloc_func().
+ @param size The number of bytes the allocation needs to hold.
+ @return @c true if the allocation holds at least @p size bytes.
+ */
+VECTOR_EXTERN bool vector_cache_try_expand_func(void *ptr, size_t size);
+
+/**
+ A free() function that returns allocations to the calling thread's cache.
+
+ Suitable for vector_set_global_free_func(). An allocation is released to the system allocator
+ instead when it is too large to cache or the free list for its class is full.
+
+ @param ptr An allocation from vector_cache_realloc_func(), or @c NULL.
+ */
+VECTOR_EXTERN void vector_cache_free_func(void *ptr);
+
+/**
+ Release every allocation cached by the calling thread to the system allocator.
+ */
+VECTOR_EXTERN void vector_cache_flush(void);
+
+/**
+ Return the number of allocations currently cached by the calling thread.
+
+ @return The number of cached allocations.
+ */
+VECTOR_EXTERN size_t vector_cache_count(void);
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_CHECK_H
+#define VECTOR_CHECK_H
+
+/**
+ @file vector_check.h
+
+ Argument checking for the library's functions.
+
+ The library checks arguments such as indices and sizes with @c VECTOR_CHECK(). How much checking
+ happens is chosen at compile time for each translation unit by defining @c VECTOR_CHECK_LEVEL to
+ one of:
+
+ - @c VECTOR_CHECK_FULL: checks use assert(). This is the default unless @c NDEBUG is defined. If
+   @c NDEBUG is defined anyway, checks behave as @c VECTOR_CHECK_CHEAP.
+ - @c VECTOR_CHECK_CHEAP: checks are compiled as a branch predicted not to be taken. A failed check
+   prints a message with the library's vfprintf() function and calls the library's abort() function.
+   This is the default when @c NDEBUG is defined.
+ - @c VECTOR_CHECK_NONE: checks are removed entirely.
+
+ For example, compiling @c vector.c with <tt>-O3 -DNDEBUG</tt> keeps cheap checks, and adding
+ <tt>-DVECTOR_CHECK_LEVEL=VECTOR_CHECK_NONE</tt> removes them.
+ */
+
+#include "vector_environment.h"
+
+/** Perform no argument checks. */
+#define VECTOR_CHECK_NONE 0
+
+/** Check arguments with a predicted branch that calls the library's abort() function on failure. */
+#define VECTOR_CHECK_CHEAP 1
+
+/** Check arguments with assert(). */
+#define VECTOR_CHECK_FULL 2
+
+#ifndef VECTOR_CHECK_LEVEL
+#   ifdef NDEBUG
+#       define VECTOR_CHECK_LEVEL VECTOR_CHECK_CHEAP
+#   else
+#       define VECTOR_CHECK_LEVEL VECTOR_CHECK_FULL
+#   endif
+#endif
+
+#if defined(__GNUC__)
+#   define VECTOR_UNLIKELY(condition) __builtin_expect(!!(condition), 0)
+#   define VECTOR_COLD __attribute__((cold, noinline))
+#else
+#   define VECTOR_UNLIKELY(condition) (condition)
+#   define VECTOR_COLD
+#endif
+
+/**
+ Report a failed argument check and call the library's abort() function.
+
+ Called by @c VECTOR_CHECK() at the @c VECTOR_CHECK_CHEAP level; not normally called directly.
+
+ @param condition The text of the condition that failed.
+ @param file      The source file of the check.
+ @param line      The source line of the check.
+ */
+VECTOR_EXTERN VECTOR_COLD void vector_check_failed(const char *condition, const char *file, int line);
+
+/** Check that a condition on a function's arguments holds, at the configured checking level. */
+#if VECTOR_CHECK_LEVEL >= VECTOR_CHECK_FULL && !defined(NDEBUG)
+#   include <assert.h>
+#   define VECTOR_CHECK(condition) assert(condition)
+#elif VECTOR_CHECK_LEVEL >= VECTOR_CHECK_CHEAP
+#   define VECTOR_CHECK(condition) \
+        ((void)(VECTOR_UNLIKELY(!(condition)) ? (vector_check_failed(#condition, __FILE__, __LINE__), 0) : 0))
+#else
+#   define VECTOR_CHECK(condition) ((void)0)
+#endif
+
+#endif
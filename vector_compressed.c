@@ -0,0 +1,243 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_compressed.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+
+static const size_t WORD_BITS = 64;
+
+// A block of up to VECTOR_COMPRESSED_BLOCK_SIZE values. Value i of the block is packed in bits
+// [i * bits, (i + 1) * bits) of the words starting at word_offset. For the delta codec, packed
+// value 0 is always zero and the first value is the reference.
+typedef struct block_t {
+    size_t word_offset;
+    uint32_t reference;
+    uint8_t bits;
+} block_t;
+
+struct vector_compressed_t {
+    size_t size;
+    vector_codec_t codec;
+    vector_t *blocks;
+    vector_t *words;
+};
+
+static inline const block_t *block_at(const vector_compressed_t *compressed, const size_t block) {
+    return (const block_t *)vector_data(compressed->blocks) + block;
+}
+
+static inline size_t block_length(const vector_compressed_t *compressed, const size_t block) {
+    const size_t start = block * VECTOR_COMPRESSED_BLOCK_SIZE;
+    const size_t remaining = compressed->size - start;
+    return remaining < VECTOR_COMPRESSED_BLOCK_SIZE ? remaining : VECTOR_COMPRESSED_BLOCK_SIZE;
+}
+
+static inline uint8_t bits_needed(uint32_t value) {
+    uint8_t bits = 0;
+    while (value) {
+        ++bits;
+        value >>= 1;
+    }
+    return bits;
+}
+
+static inline uint32_t read_packed(const uint64_t *words, const uint8_t bits, const size_t index) {
+    if (bits == 0) {
+        return 0;
+    }
+    const size_t position = index * bits;
+    const size_t word = position / WORD_BITS;
+    const size_t shift = position % WORD_BITS;
+    uint64_t value = words[word] >> shift;
+    if (shift + bits > WORD_BITS) {
+        value |= words[word + 1] << (WORD_BITS - shift);
+    }
+    return (uint32_t)(value & (((uint64_t)1 << bits) - 1));
+}
+
+static inline void write_packed(uint64_t *words, const uint8_t bits, const size_t index, const uint32_t value) {
+    const size_t position = index * bits;
+    const size_t word = position / WORD_BITS;
+    const size_t shift = position % WORD_BITS;
+    words[word] |= (uint64_t)value << shift;
+    if (shift + bits > WORD_BITS) {
+        words[word + 1] |= (uint64_t)value >> (WORD_BITS - shift);
+    }
+}
+
+static void compress_block(vector_compressed_t *compressed, const uint32_t *values, const size_t count) {
+    uint32_t packed[VECTOR_COMPRESSED_BLOCK_SIZE];
+    uint32_t reference = values[0];
+    if (compressed->codec == VECTOR_CODEC_FOR) {
+        for (size_t i = 1; i < count; ++i) {
+            reference = values[i] < reference ? values[i] : reference;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            packed[i] = values[i] - reference;
+        }
+    } else {
+        packed[0] = 0;
+        for (size_t i = 1; i < count; ++i) {
+            packed[i] = values[i] - values[i - 1];
+        }
+    }
+
+    uint32_t all_bits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        all_bits |= packed[i];
+    }
+
+    block_t *block = vector_emplace_back(compressed->blocks);
+    if (!block) {
+        return;
+    }
+    block->reference = reference;
+    block->bits = bits_needed(all_bits);
+    block->word_offset = vector_size(compressed->words);
+
+    const size_t num_words = (count * block->bits + WORD_BITS - 1) / WORD_BITS;
+    if (num_words > 0) {
+        uint64_t *words = vector_emplace_back_n(compressed->words, num_words);
+        if (!words) {
+            return;
+        }
+        for (size_t i = 0; i < num_words; ++i) {
+            words[i] = 0;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            write_packed(words, block->bits, i, packed[i]);
+        }
+    }
+}
+
+// Decode a whole block into values.
+static void decode_block(const vector_compressed_t *compressed, const size_t block_index, uint32_t *values) {
+    const block_t *block = block_at(compressed, block_index);
+    const uint64_t *words = (const uint64_t *)vector_data(compressed->words) + block->word_offset;
+    const size_t count = block_length(compressed, block_index);
+    if (compressed->codec == VECTOR_CODEC_FOR) {
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = block->reference + read_packed(words, block->bits, i);
+        }
+    } else {
+        uint32_t value = block->reference;
+        values[0] = value;
+        for (size_t i = 1; i < count; ++i) {
+            value += read_packed(words, block->bits, i);
+            values[i] = value;
+        }
+    }
+}
+
+vector_compressed_t *vector_compress(const vector_t *vector, const vector_codec_t codec) {
+    VECTOR_CHECK(vector && vector_element_size(vector) == sizeof(uint32_t));
+    VECTOR_CHECK(codec == VECTOR_CODEC_FOR || codec == VECTOR_CODEC_DELTA);
+    vector_compressed_t *compressed = vector_system_realloc(NULL, sizeof(vector_compressed_t));
+    if (!compressed) {
+        return NULL;
+    }
+    compressed->size = vector_size(vector);
+    compressed->codec = codec;
+    compressed->blocks = vector_create(sizeof(block_t));
+    compressed->words = vector_create(sizeof(uint64_t));
+    if (!compressed->blocks || !compressed->words) {
+        vector_compressed_destroy(compressed);
+        return NULL;
+    }
+
+    const size_t num_blocks = (compressed->size + VECTOR_COMPRESSED_BLOCK_SIZE - 1) / VECTOR_COMPRESSED_BLOCK_SIZE;
+    vector_reserve(compressed->blocks, num_blocks);
+    const uint32_t *values = vector_data(vector);
+    for (size_t i = 0; i < num_blocks; ++i) {
+        compress_block(compressed, values + i * VECTOR_COMPRESSED_BLOCK_SIZE, block_length(compressed, i));
+    }
+    vector_size_to_fit(compressed->words);
+    return compressed;
+}
+
+vector_t *vector_decompress(const vector_compressed_t *compressed) {
+    VECTOR_CHECK(compressed);
+    vector_t *vector = vector_create_with_size(sizeof(uint32_t), compressed->size);
+    if (vector) {
+        vector_compressed_decode(compressed, 0, compressed->size, vector_data(vector));
+    }
+    return vector;
+}
+
+void vector_compressed_destroy(vector_compressed_t *compressed) {
+    VECTOR_CHECK(compressed);
+    if (compressed->blocks) {
+        vector_destroy(compressed->blocks);
+    }
+    if (compressed->words) {
+        vector_destroy(compressed->words);
+    }
+    vector_system_free(compressed);
+}
+
+size_t vector_compressed_size(const vector_compressed_t *compressed) {
+    VECTOR_CHECK(compressed);
+    return compressed->size;
+}
+
+size_t vector_compressed_bytes(const vector_compressed_t *compressed) {
+    VECTOR_CHECK(compressed);
+    return vector_capacity(compressed->blocks) * sizeof(block_t) +
+           vector_capacity(compressed->words) * sizeof(uint64_t);
+}
+
+uint32_t vector_compressed_get(const vector_compressed_t *compressed, const size_t index) {
+    VECTOR_CHECK(compressed && index < compressed->size);
+    const block_t *block = block_at(compressed, index / VECTOR_COMPRESSED_BLOCK_SIZE);
+    const uint64_t *words = (const uint64_t *)vector_data(compressed->words) + block->word_offset;
+    const size_t offset = index % VECTOR_COMPRESSED_BLOCK_SIZE;
+    if (compressed->codec == VECTOR_CODEC_FOR) {
+        return block->reference + read_packed(words, block->bits, offset);
+    }
+    uint32_t value = block->reference;
+    for (size_t i = 1; i <= offset; ++i) {
+        value += read_packed(words, block->bits, i);
+    }
+    return value;
+}
+
+void vector_compressed_decode(const vector_compressed_t *compressed, const size_t start,
+                              const size_t count, uint32_t *values) {
+    VECTOR_CHECK(compressed && start <= compressed->size && count <= compressed->size - start);
+    VECTOR_CHECK(count == 0 || values);
+    uint32_t scratch[VECTOR_COMPRESSED_BLOCK_SIZE];
+    size_t index = start;
+    const size_t end = start + count;
+    while (index < end) {
+        const size_t block = index / VECTOR_COMPRESSED_BLOCK_SIZE;
+        const size_t offset = index % VECTOR_COMPRESSED_BLOCK_SIZE;
+        const size_t length = block_length(compressed, block);
+        const size_t wanted = (end - index) < (length - offset) ? (end - index) : (length - offset);
+        if (offset == 0 && wanted == length) {
+            decode_block(compressed, block, values);
+        } else {
+            decode_block(compressed, block, scratch);
+            for (size_t i = 0; i < wanted; ++i) {
+                values[i] = scratch[offset + i];
+            }
+        }
+        values += wanted;
+        index += wanted;
+    }
+}
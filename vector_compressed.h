@@ -0,0 +1,126 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_COMPRESSED_H
+#define VECTOR_COMPRESSED_H
+
+/**
+ @file vector_compressed.h
+
+ Read-only compressed vectors of 32-bit unsigned integers (optional).
+
+ @c vector_compress() freezes a vector of @c uint32_t into blocks of @c VECTOR_COMPRESSED_BLOCK_SIZE
+ values. Each block stores a reference value and bit-packs the remaining information with the
+ fewest bits that hold it:
+
+ - @c VECTOR_CODEC_FOR (frame of reference) packs each value minus the block's minimum, which suits
+   values from a small range.
+ - @c VECTOR_CODEC_DELTA packs the difference between consecutive values, which suits sorted values
+   such as posting lists.
+
+ A block index gives random access to any value, and whole blocks decode sequentially.
+ */
+
+#include <stdint.h>
+
+#include "vector.h"
+
+/** The number of values in each compressed block. */
+#define VECTOR_COMPRESSED_BLOCK_SIZE 128
+
+/** The available compression methods. */
+typedef enum vector_codec_t {
+    VECTOR_CODEC_FOR,
+    VECTOR_CODEC_DELTA,
+} vector_codec_t;
+
+/** An anonymous structure for storing a compressed vector's state. */
+struct vector_compressed_t;
+
+/** A frozen, compressed array of 32-bit unsigned integers. */
+typedef struct vector_compressed_t vector_compressed_t;
+
+/**
+ Compress a vector of 32-bit unsigned integers.
+
+ The vector's element size must be @c sizeof(uint32_t). The vector is not modified.
+
+ @param vector A vector of @c uint32_t.
+ @param codec  The compression method.
+
+ @return A new compressed copy of @c vector.
+ */
+VECTOR_EXTERN vector_compressed_t *vector_compress(const vector_t *vector, const vector_codec_t codec);
+
+/**
+ Decompress a compressed vector.
+
+ @param compressed A compressed vector.
+
+ @return A new vector of @c uint32_t with the original values.
+ */
+VECTOR_EXTERN vector_t *vector_decompress(const vector_compressed_t *compressed);
+
+/**
+ Destroy a compressed vector and deallocate its memory.
+
+ @param compressed A compressed vector.
+ */
+VECTOR_EXTERN void vector_compressed_destroy(vector_compressed_t *compressed);
+
+/**
+ Return the number of values in a compressed vector.
+
+ @param compressed A compressed vector.
+
+ @return The number of values.
+ */
+VECTOR_EXTERN size_t vector_compressed_size(const vector_compressed_t *compressed);
+
+/**
+ Return the memory used by a compressed vector's block index and packed values.
+
+ @param compressed A compressed vector.
+
+ @return A size in bytes.
+ */
+VECTOR_EXTERN size_t vector_compressed_bytes(const vector_compressed_t *compressed);
+
+/**
+ Get a value from a compressed vector.
+
+ Frame-of-reference values are read directly. Delta values are decoded from the start of their
+ block, so sequential access should use @c vector_compressed_decode() instead.
+
+ @param compressed A compressed vector.
+ @param index      An index in the range of [0, size - 1].
+
+ @return The value.
+ */
+VECTOR_EXTERN uint32_t vector_compressed_get(const vector_compressed_t *compressed, const size_t index);
+
+/**
+ Decode a range of values from a compressed vector.
+
+ @param compressed A compressed vector.
+ @param start      The index of the first value, in the range of [0, size].
+ @param count      The number of values, with @c start + @c count at most the size.
+ @param values     An array of at least @c count values to decode into.
+ */
+VECTOR_EXTERN void vector_compressed_decode(const vector_compressed_t *compressed, const size_t start,
+                                            const size_t count, uint32_t *values);
+
+#endif
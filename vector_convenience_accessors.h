@@ -117,6 +117,9 @@
 
  The vector's @c member_size must match @c sizeof(value).
 
+ The value is evaluated before the vector grows, so it may refer to one of the vector's own
+ elements. It is copied into the vector with the vector's copy function, if it has one.
+
  @param vector A vector.
  @param value  The new value.
  */
@@ -134,6 +137,9 @@
 
  The vector's @c member_size must match @c sizeof(value).
 
+ The value is evaluated before the vector grows, so it may refer to one of the vector's own
+ elements. It is copied into the vector with the vector's copy function, if it has one.
+
  @param vector A vector.
  @param pos    The index of the new element.
  @param value  The new value.
@@ -0,0 +1,161 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_CURSOR_H
+#define VECTOR_CURSOR_H
+
+/**
+ @file vector_cursor.h
+
+ Inline traversal of a vector's elements (optional).
+
+ Calling @c vector_get() for every element costs a function call, a check and a multiplication per
+ element. A cursor reads the vector's storage once and then steps through the elements with
+ inlined pointer arithmetic:
+
+ @code
+ for (vector_cursor_t cursor = vector_begin(vector); !vector_end(&cursor); vector_next(&cursor)) {
+     struct point *point = vector_cursor_get(&cursor);
+     ...
+ }
+ @endcode
+
+ Cursors can visit every n-th element, and can issue software prefetches some distance ahead, which
+ helps when elements are large and the vector is much larger than the cache. For the common case of
+ visiting every element with a known type, @c VECTOR_FOREACH() is shorter.
+
+ As with element pointers, a cursor is invalidated by anything that reallocates the vector's
+ storage, and does not see elements added after it was created.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+#include "vector_check.h"
+
+/** A position in a traversal of a vector's elements. */
+typedef struct vector_cursor_t {
+    char *element;          /**< The current element. */
+    size_t remaining;       /**< The number of elements left to visit, including the current one. */
+    size_t step;            /**< The distance between visited elements in bytes. */
+    size_t prefetch_count;  /**< How many visited elements ahead to prefetch, or zero for none. */
+} vector_cursor_t;
+
+/**
+ Visit every element of a vector of type @c type, with @c pointer pointing to each in turn.
+
+ The vector's element size must be @c sizeof(type).
+
+ @code
+ VECTOR_FOREACH(vector, int, value) {
+     sum += *value;
+ }
+ @endcode
+ */
+#define VECTOR_FOREACH(vector, type, pointer) \
+    for (type *pointer = (type *)vector_data(vector), \
+              *vector_foreach_end_##pointer = pointer + vector_size(vector); \
+         pointer != vector_foreach_end_##pointer; \
+         ++pointer)
+
+/**
+ Return a cursor that visits every @c stride-th element of a vector, starting at @c first.
+
+ @param vector A vector.
+ @param first  The index of the first element to visit, at most the vector's size.
+ @param stride The distance between visited elements in elements, at least 1.
+
+ @return A cursor at the first element, or at the end if there are no elements to visit.
+ */
+static inline vector_cursor_t vector_begin_strided(const vector_t *vector, const size_t first, const size_t stride) {
+    const size_t size = vector_size(vector);
+    VECTOR_CHECK(first <= size && stride > 0);
+    const size_t element_size = vector_element_size(vector);
+    vector_cursor_t cursor;
+    cursor.remaining = first < size && stride > 0 ? (size - first + stride - 1) / stride : 0;
+    cursor.element = cursor.remaining > 0 ? (char *)vector_data(vector) + first * element_size : NULL;
+    cursor.step = stride * element_size;
+    cursor.prefetch_count = 0;
+    return cursor;
+}
+
+/**
+ Return a cursor that visits every element of a vector.
+
+ @param vector A vector.
+
+ @return A cursor at the first element, or at the end if the vector is empty.
+ */
+static inline vector_cursor_t vector_begin(const vector_t *vector) {
+    return vector_begin_strided(vector, 0, 1);
+}
+
+/**
+ Make a cursor prefetch the element @c count visits ahead of the current one.
+
+ Prefetching pays off when elements are large or strided and the vector does not fit in the cache;
+ for small contiguous elements the hardware prefetcher is usually enough. Without compiler support
+ for prefetching, this does nothing.
+
+ @param cursor A cursor.
+ @param count  How many visits ahead to prefetch, or zero to stop prefetching.
+ */
+static inline void vector_cursor_set_prefetch(vector_cursor_t *cursor, const size_t count) {
+    cursor->prefetch_count = count;
+}
+
+/**
+ Return whether a cursor has visited every element.
+
+ @param cursor A cursor.
+
+ @return @c true if there is no current element.
+ */
+static inline bool vector_end(const vector_cursor_t *cursor) {
+    return cursor->remaining == 0;
+}
+
+/**
+ Return a cursor's current element.
+
+ @param cursor A cursor that is not at the end.
+
+ @return A pointer to the current element.
+ */
+static inline void *vector_cursor_get(const vector_cursor_t *cursor) {
+    VECTOR_CHECK(cursor->remaining > 0);
+    return cursor->element;
+}
+
+/**
+ Move a cursor to the next element it visits.
+
+ @param cursor A cursor that is not at the end.
+ */
+static inline void vector_next(vector_cursor_t *cursor) {
+    VECTOR_CHECK(cursor->remaining > 0);
+#if defined(__GNUC__)
+    if (cursor->prefetch_count > 0 && cursor->remaining > cursor->prefetch_count) {
+        __builtin_prefetch(cursor->element + cursor->prefetch_count * cursor->step);
+    }
+#endif
+    if (--cursor->remaining > 0) {
+        cursor->element += cursor->step;
+    }
+}
+
+#endif
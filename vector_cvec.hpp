@@ -0,0 +1,324 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_CVEC_HPP
+#define VECTOR_CVEC_HPP
+
+/**
+ @file vector_cvec.hpp
+
+ A C++ wrapper around vector_t (optional, requires C++11).
+
+ @c cvec<T> owns a @c vector_t of @c T and offers the familiar parts of the @c std::vector
+ interface: construction, copying and moving, element access, iterators that work with
+ @c <algorithm>, @c push_back() and @c emplace_back(). Moving a @c cvec transfers the underlying
+ vector without copying elements, and @c get() and @c release() expose the @c vector_t so that C++
+ and C code can share a buffer without copying it. A @c cvec that has been moved from or released
+ is left empty and may be used as usual. With C++20, a @c cvec converts to @c std::span.
+
+ Elements that are not trivially copyable are copied, moved and destroyed with their constructors
+ and destructor by installing element functions (see vector_set_element_funcs()) on the vector.
+ Because the library relocates elements from C, @c T must be nothrow move constructible. Copies
+ made by the library, such as when a @c cvec is copied or an element is copied into the vector from
+ C, also run from C, so a copy constructor that throws there calls @c std::terminate(). Elements
+ must need no more alignment than @c std::max_align_t, which is all the library's realloc()
+ function guarantees. Growth failures throw @c std::bad_alloc if the library's abort() function
+ returns.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__has_include)
+#   if __has_include(<span>) && __cplusplus >= 202002L
+#       include <span>
+#   endif
+#endif
+
+#include "vector.h"
+
+template <typename T>
+class cvec {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "cvec elements must be nothrow move constructible");
+    static_assert(std::is_nothrow_destructible<T>::value, "cvec elements must be nothrow destructible");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "cvec elements must not be over-aligned");
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /** Create an empty vector. */
+    cvec() : vector_(create()) {}
+
+    /** Create a vector of @p size value-initialized elements. */
+    explicit cvec(size_type size) : vector_(create()) {
+        reserve(size);
+        for (size_type i = 0; i < size; ++i) {
+            emplace_back();
+        }
+    }
+
+    /** Create a vector of @p size copies of @p value. */
+    cvec(size_type size, const T &value) : vector_(create()) {
+        reserve(size);
+        for (size_type i = 0; i < size; ++i) {
+            push_back(value);
+        }
+    }
+
+    /** Create a vector holding copies of the values in a list. */
+    cvec(std::initializer_list<T> values) : vector_(create()) {
+        reserve(values.size());
+        for (const T &value : values) {
+            push_back(value);
+        }
+    }
+
+    /**
+     Take ownership of an existing vector of @c T without copying.
+
+     The vector's element functions are replaced with ones for @c T.
+     */
+    explicit cvec(vector_t *vector) : vector_(vector) {
+        if (!vector_ || vector_element_size(vector_) != sizeof(T)) {
+            throw std::invalid_argument("cvec requires a vector with elements of sizeof(T) bytes");
+        }
+        vector_set_element_funcs(vector_, element_funcs());
+    }
+
+    cvec(const cvec &other) : vector_(vector_create_with_vector(other.vector_)) {
+        if (!vector_) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     Take the other vector's storage without copying elements, leaving the other vector empty.
+
+     The other vector is given a new, empty @c vector_t. If that small allocation fails, the
+     exception cannot leave this constructor and @c std::terminate() is called.
+     */
+    cvec(cvec &&other) noexcept : vector_(create()) { swap(other); }
+
+    ~cvec() { vector_destroy(vector_); }
+
+    cvec &operator=(const cvec &other) {
+        if (this != &other) {
+            cvec copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    /** Take the other vector's storage without copying elements, leaving the other vector empty. */
+    cvec &operator=(cvec &&other) noexcept {
+        if (this != &other) {
+            swap(other);
+            other.clear();
+        }
+        return *this;
+    }
+
+    /** Return the underlying vector, which remains owned by this object. */
+    vector_t *get() const noexcept { return vector_; }
+
+    /**
+     Give up ownership of the underlying vector and return it, leaving this object with a new, empty
+     vector. Throws @c std::bad_alloc, leaving this object unchanged, if that vector cannot be created.
+     */
+    vector_t *release() {
+        vector_t *vector = vector_;
+        vector_ = create();
+        return vector;
+    }
+
+    void swap(cvec &other) noexcept { std::swap(vector_, other.vector_); }
+
+    bool empty() const noexcept { return vector_empty(vector_); }
+    size_type size() const noexcept { return vector_size(vector_); }
+    size_type max_size() const noexcept { return vector_max_size(vector_); }
+    size_type capacity() const noexcept { return vector_capacity(vector_); }
+
+    void reserve(size_type capacity) {
+        vector_reserve(vector_, capacity);
+        if (vector_capacity(vector_) < capacity) {
+            throw std::bad_alloc();
+        }
+    }
+
+    void shrink_to_fit() { vector_size_to_fit(vector_); }
+    void clear() noexcept { vector_clear(vector_); }
+
+    /** Resize, value-initializing any new elements. */
+    void resize(size_type size) {
+        if (size < this->size()) {
+            vector_resize(vector_, size);
+        } else {
+            reserve(size);
+            while (this->size() < size) {
+                emplace_back();
+            }
+        }
+    }
+
+    T *data() noexcept { return static_cast<T *>(vector_data(vector_)); }
+    const T *data() const noexcept { return static_cast<const T *>(vector_data(vector_)); }
+
+    T &operator[](size_type index) noexcept { return data()[index]; }
+    const T &operator[](size_type index) const noexcept { return data()[index]; }
+
+    T &at(size_type index) {
+        check_index(index);
+        return data()[index];
+    }
+
+    const T &at(size_type index) const {
+        check_index(index);
+        return data()[index];
+    }
+
+    T &front() noexcept { return *static_cast<T *>(vector_front(vector_)); }
+    const T &front() const noexcept { return *static_cast<const T *>(vector_front(vector_)); }
+    T &back() noexcept { return *static_cast<T *>(vector_back(vector_)); }
+    const T &back() const noexcept { return *static_cast<const T *>(vector_back(vector_)); }
+
+    iterator begin() noexcept { return data(); }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator cbegin() const noexcept { return data(); }
+    iterator end() noexcept { return data() + size(); }
+    const_iterator end() const noexcept { return data() + size(); }
+    const_iterator cend() const noexcept { return data() + size(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    /** Construct an element in place at the end of the vector. */
+    template <typename... Args>
+    T &emplace_back(Args &&...args) {
+        // The arguments may refer to elements of this vector, and a throwing constructor must leave
+        // the vector unchanged, so construct in place only when neither growth nor throwing can
+        // happen. Otherwise construct first and move the element into place.
+        if (std::is_nothrow_constructible<T, Args...>::value && size() < capacity()) {
+            return *new (emplace_slot()) T(std::forward<Args>(args)...);
+        }
+        T value(std::forward<Args>(args)...);
+        return *new (emplace_slot()) T(std::move(value));
+    }
+
+    void pop_back() noexcept { vector_pop_back(vector_); }
+
+    /** Remove the element at @p pos, returning an iterator to the element after it. */
+    iterator erase(const_iterator pos) noexcept {
+        const size_type index = static_cast<size_type>(pos - cbegin());
+        vector_erase(vector_, index);
+        return begin() + index;
+    }
+
+    /** Remove the elements in [@p first, @p last), returning an iterator to the element after them. */
+    iterator erase(const_iterator first, const_iterator last) {
+        const size_type index = static_cast<size_type>(first - cbegin());
+        const size_type count = static_cast<size_type>(last - first);
+        std::move(begin() + index + count, end(), begin() + index);
+        vector_resize(vector_, size() - count);
+        return begin() + index;
+    }
+
+#if defined(__cpp_lib_span)
+    operator std::span<T>() noexcept { return std::span<T>(data(), size()); }
+    operator std::span<const T>() const noexcept { return std::span<const T>(data(), size()); }
+#endif
+
+private:
+    vector_t *vector_;
+
+    // Exceptions cannot propagate through the C library, so a throwing copy calls std::terminate().
+    static void copy_element(void *dst, const void *src) noexcept {
+        new (dst) T(*static_cast<const T *>(src));
+    }
+
+    static void move_element(void *dst, void *src) noexcept {
+        T *source = static_cast<T *>(src);
+        new (dst) T(std::move(*source));
+        source->~T();
+    }
+
+    static void destroy_element(void *element) noexcept {
+        static_cast<T *>(element)->~T();
+    }
+
+    // Copying is only possible for copy constructible elements; others have no copy function, and
+    // copying the cvec will not compile.
+    static vector_element_copy_func_t copy_func(std::true_type) noexcept { return copy_element; }
+    static vector_element_copy_func_t copy_func(std::false_type) noexcept { return nullptr; }
+
+    static const vector_element_funcs_t *element_funcs() noexcept {
+        static const vector_element_funcs_t funcs = {
+            copy_func(std::integral_constant<bool, std::is_copy_constructible<T>::value>()),
+            move_element,
+            destroy_element,
+        };
+        return std::is_trivially_copyable<T>::value ? nullptr : &funcs;
+    }
+
+    static vector_t *create() {
+        vector_t *vector = vector_create(sizeof(T));
+        if (!vector) {
+            throw std::bad_alloc();
+        }
+        vector_set_element_funcs(vector, element_funcs());
+        return vector;
+    }
+
+    void check_index(size_type index) const {
+        if (index >= size()) {
+            throw std::out_of_range("cvec index out of range");
+        }
+    }
+
+    void *emplace_slot() {
+        void *slot = vector_emplace_back(vector_);
+        if (!slot) {
+            throw std::bad_alloc();
+        }
+        return slot;
+    }
+};
+
+template <typename T>
+void swap(cvec<T> &first, cvec<T> &second) noexcept {
+    first.swap(second);
+}
+
+#endif
@@ -30,4 +30,15 @@
 #   define VECTOR_EXTERN extern
 #endif
 
+/** Declares a variable with thread storage duration. Not defined if the compiler has no support. */
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#   define VECTOR_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#   define VECTOR_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#   define VECTOR_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#   define VECTOR_THREAD_LOCAL __declspec(thread)
+#endif
+
 #endif
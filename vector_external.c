@@ -0,0 +1,339 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector_external.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// Marks a page that is not in the window, and a frame that holds no page.
+#define NO_FRAME SIZE_MAX
+#define NO_PAGE SIZE_MAX
+
+// A slot in the window that holds one page in memory.
+typedef struct frame_t {
+    char *data;
+    size_t page;
+    uint64_t last_use;      // The value of the vector's clock when the page was last used.
+    bool dirty;             // Whether the page has changed since it was last written to the file.
+} frame_t;
+
+struct vector_external_t {
+    size_t element_size;
+    size_t elements_per_page;
+    size_t page_bytes;
+    size_t size;
+    int fd;
+
+    frame_t *frames;
+    size_t frame_count;
+    vector_t *page_frames;  // The frame holding each page, or NO_FRAME if the page is in the file.
+    uint64_t clock;
+
+    size_t readahead;
+    size_t last_read;       // The page most recently read from the file, or NO_PAGE.
+};
+
+static void external_fail(const char *format, ...);
+
+static inline off_t page_offset(const vector_external_t *external, const size_t page) {
+    return (off_t)page * (off_t)external->page_bytes;
+}
+
+static inline size_t *page_frame(vector_external_t *external, const size_t page) {
+    return (size_t *)vector_data(external->page_frames) + page;
+}
+
+static bool write_page(vector_external_t *external, const frame_t *frame) {
+    const char *data = frame->data;
+    size_t remaining = external->page_bytes;
+    off_t offset = page_offset(external, frame->page);
+    while (remaining > 0) {
+        const ssize_t written = pwrite(external->fd, data, remaining, offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            external_fail("Could not write page %zu of an external vector: %s", frame->page, strerror(errno));
+            return false;
+        }
+        data += written;
+        offset += written;
+        remaining -= (size_t)written;
+    }
+    return true;
+}
+
+static bool read_page(vector_external_t *external, frame_t *frame) {
+    char *data = frame->data;
+    size_t remaining = external->page_bytes;
+    off_t offset = page_offset(external, frame->page);
+    while (remaining > 0) {
+        const ssize_t count = pread(external->fd, data, remaining, offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            external_fail("Could not read page %zu of an external vector: %s", frame->page,
+                          count < 0 ? strerror(errno) : "end of file");
+            return false;
+        }
+        data += count;
+        offset += count;
+        remaining -= (size_t)count;
+    }
+    return true;
+}
+
+// Free a frame for a new page, writing out the least recently used page if the window is full.
+static frame_t *evict(vector_external_t *external) {
+    frame_t *victim = &external->frames[0];
+    for (size_t i = 0; i < external->frame_count; ++i) {
+        frame_t *frame = &external->frames[i];
+        if (frame->page == NO_PAGE) {
+            return frame;
+        }
+        if (frame->last_use < victim->last_use) {
+            victim = frame;
+        }
+    }
+    if (victim->dirty && !write_page(external, victim)) {
+        return NULL;
+    }
+    *page_frame(external, victim->page) = NO_FRAME;
+    victim->page = NO_PAGE;
+    victim->dirty = false;
+    return victim;
+}
+
+// Return the frame holding a page, reading the page from the file if it is not in the window.
+static frame_t *load(vector_external_t *external, const size_t page) {
+    const size_t index = *page_frame(external, page);
+    frame_t *frame;
+    if (index != NO_FRAME) {
+        frame = &external->frames[index];
+    } else {
+        frame = evict(external);
+        if (!frame) {
+            return NULL;
+        }
+        frame->page = page;
+        if (!read_page(external, frame)) {
+            frame->page = NO_PAGE;
+            return NULL;
+        }
+        *page_frame(external, page) = (size_t)(frame - external->frames);
+
+#if defined(POSIX_FADV_WILLNEED)
+        // Reading pages in order suggests a scan, so have the system read the next pages ahead.
+        const size_t page_count = vector_size(external->page_frames);
+        if (external->readahead > 0 && page == external->last_read + 1 && page + 1 < page_count) {
+            const size_t ahead = page_count - page - 1 < external->readahead ? page_count - page - 1 : external->readahead;
+            posix_fadvise(external->fd, page_offset(external, page + 1), (off_t)(ahead * external->page_bytes),
+                          POSIX_FADV_WILLNEED);
+        }
+#endif
+        external->last_read = page;
+    }
+    frame->last_use = ++external->clock;
+    return frame;
+}
+
+vector_external_t *vector_external_create(const size_t element_size, size_t page_bytes, const size_t window_pages,
+                                          const char *directory) {
+    VECTOR_CHECK(element_size > 0 && window_pages > 0);
+    if (page_bytes == 0) {
+        page_bytes = VECTOR_EXTERNAL_DEFAULT_PAGE_BYTES;
+    }
+    const size_t elements_per_page = page_bytes / element_size > 0 ? page_bytes / element_size : 1;
+    if (elements_per_page > SIZE_MAX / element_size || window_pages > SIZE_MAX / sizeof(frame_t)) {
+        return NULL;
+    }
+
+    vector_external_t *external = vector_system_realloc(NULL, sizeof(vector_external_t));
+    if (!external) {
+        return NULL;
+    }
+    external->element_size = element_size;
+    external->elements_per_page = elements_per_page;
+    external->page_bytes = elements_per_page * element_size;
+    external->size = 0;
+    external->clock = 0;
+    external->readahead = VECTOR_EXTERNAL_DEFAULT_READAHEAD;
+    external->last_read = NO_PAGE;
+    external->frame_count = window_pages;
+    external->page_frames = vector_create(sizeof(size_t));
+    external->frames = vector_system_realloc(NULL, window_pages * sizeof(frame_t));
+    if (!external->page_frames || !external->frames) {
+        external->frame_count = 0;
+        external->fd = -1;
+        vector_external_destroy(external);
+        return NULL;
+    }
+    for (size_t i = 0; i < window_pages; ++i) {
+        external->frames[i].data = NULL;
+        external->frames[i].page = NO_PAGE;
+        external->frames[i].last_use = 0;
+        external->frames[i].dirty = false;
+    }
+    for (size_t i = 0; i < window_pages; ++i) {
+        external->frames[i].data = vector_system_realloc(NULL, external->page_bytes);
+        if (!external->frames[i].data) {
+            external->fd = -1;
+            vector_external_destroy(external);
+            return NULL;
+        }
+    }
+
+    if (!directory) {
+        directory = getenv("TMPDIR");
+        directory = directory && directory[0] ? directory : "/tmp";
+    }
+    static const char name[] = "/vector_external_XXXXXX";
+    const size_t directory_length = strlen(directory);
+    char *path = vector_system_realloc(NULL, directory_length + sizeof(name));
+    if (path) {
+        memcpy(path, directory, directory_length);
+        memcpy(path + directory_length, name, sizeof(name));
+        external->fd = mkstemp(path);
+        if (external->fd >= 0) {
+            unlink(path);
+        }
+        vector_system_free(path);
+    } else {
+        external->fd = -1;
+    }
+    if (external->fd < 0) {
+        vector_external_destroy(external);
+        return NULL;
+    }
+    return external;
+}
+
+void vector_external_destroy(vector_external_t *external) {
+    VECTOR_CHECK(external);
+    if (external->fd >= 0) {
+        close(external->fd);
+    }
+    for (size_t i = 0; i < external->frame_count; ++i) {
+        vector_system_free(external->frames[i].data);
+    }
+    vector_system_free(external->frames);
+    if (external->page_frames) {
+        vector_destroy(external->page_frames);
+    }
+    vector_system_free(external);
+}
+
+size_t vector_external_element_size(const vector_external_t *external) {
+    VECTOR_CHECK(external);
+    return external->element_size;
+}
+
+size_t vector_external_size(const vector_external_t *external) {
+    VECTOR_CHECK(external);
+    return external->size;
+}
+
+void vector_external_set_readahead(vector_external_t *external, const size_t pages) {
+    VECTOR_CHECK(external);
+    external->readahead = pages;
+}
+
+void vector_external_push_back(vector_external_t *external, const void *value) {
+    VECTOR_CHECK(external && value);
+    const size_t page = external->size / external->elements_per_page;
+    const size_t offset = external->size % external->elements_per_page;
+    frame_t *frame;
+    if (offset == 0) {
+        // Start a new page in the window without reading it.
+        const size_t index = vector_size(external->page_frames);
+        vector_push_back(external->page_frames, &(size_t){ NO_FRAME });
+        if (vector_size(external->page_frames) == index) {
+            return;
+        }
+        frame = evict(external);
+        if (!frame) {
+            vector_pop_back(external->page_frames);
+            return;
+        }
+        frame->page = page;
+        *page_frame(external, page) = (size_t)(frame - external->frames);
+        frame->last_use = ++external->clock;
+    } else {
+        frame = load(external, page);
+        if (!frame) {
+            return;
+        }
+    }
+    vector_system_memcpy(frame->data + offset * external->element_size, value, external->element_size);
+    frame->dirty = true;
+    ++external->size;
+}
+
+const void *vector_external_get(vector_external_t *external, const size_t index) {
+    VECTOR_CHECK(external && index < external->size);
+    const frame_t *frame = load(external, index / external->elements_per_page);
+    return frame ? frame->data + index % external->elements_per_page * external->element_size : NULL;
+}
+
+void vector_external_set(vector_external_t *external, const size_t index, const void *value) {
+    VECTOR_CHECK(external && index < external->size && value);
+    frame_t *frame = load(external, index / external->elements_per_page);
+    if (frame) {
+        vector_system_memcpy(frame->data + index % external->elements_per_page * external->element_size, value,
+                             external->element_size);
+        frame->dirty = true;
+    }
+}
+
+void vector_external_scan(vector_external_t *external, const size_t first, const size_t last,
+                          const vector_external_scan_func_t func, void *context) {
+    VECTOR_CHECK(external && first <= last && last <= external->size && func);
+    for (size_t index = first; index < last;) {
+        const size_t page = index / external->elements_per_page;
+        const size_t offset = index % external->elements_per_page;
+        const size_t page_end = (page + 1) * external->elements_per_page;
+        const size_t end = page_end < last ? page_end : last;
+        const frame_t *frame = load(external, page);
+        if (!frame) {
+            return;
+        }
+        func(context, frame->data + offset * external->element_size, end - index);
+        index = end;
+    }
+}
+
+// Report an I/O error and call the library's abort() function.
+static void external_fail(const char *format, ...) {
+    va_list arg_pointers;
+    va_start(arg_pointers, format);
+    vector_system_vfprintf(stderr, format, arg_pointers);
+    va_end(arg_pointers);
+    vector_system_abort();
+}
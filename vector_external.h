@@ -0,0 +1,161 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_EXTERNAL_H
+#define VECTOR_EXTERNAL_H
+
+/**
+ @file vector_external.h
+
+ A vector of fixed-sized objects that spills to a temporary file (optional, requires POSIX).
+
+ A @c vector_external_t stores its elements in fixed-size pages. At most a fixed number of pages,
+ the window, is held in memory; when another page is needed, the least recently used page in the
+ window is written to an anonymous temporary file if it has changed, and the needed page is read
+ from the file. Memory use is therefore bounded by the window, however many elements are stored,
+ and a data set larger than memory degrades to disk speed instead of failing to allocate.
+
+ The file is written and read a page at a time with pwrite() and pread(). Appending writes pages in
+ order, and a scan that reads pages in order asks the system to read the following pages ahead with
+ posix_fadvise(), so both run at close to the disk's sequential bandwidth. Random access is
+ supported but costs a disk read per page outside the window.
+
+ Elements are copied bytewise, so element functions are not supported. If the temporary file
+ cannot be written or read, the library prints a message and calls its abort() function.
+ */
+
+#include "vector.h"
+
+/** The page size used when zero is passed to vector_external_create(). */
+#define VECTOR_EXTERNAL_DEFAULT_PAGE_BYTES ((size_t)1 << 20)
+
+/** The number of pages read ahead of a sequential scan, unless set with vector_external_set_readahead(). */
+#define VECTOR_EXTERNAL_DEFAULT_READAHEAD 4
+
+/** An anonymous structure for storing an external vector's state. */
+struct vector_external_t;
+
+/** A sequence of fixed-sized members that keeps only a window of them in memory. */
+typedef struct vector_external_t vector_external_t;
+
+/**
+ A function that processes a contiguous run of an external vector's elements.
+
+ @param context  The context passed to vector_external_scan().
+ @param elements The first element of the run, valid until the function returns.
+ @param count    The number of elements in the run.
+ */
+typedef void (*vector_external_scan_func_t)(void *context, const void *elements, size_t count);
+
+/**
+ Create an empty external vector backed by a new temporary file.
+
+ The file is removed from its directory as soon as it is created, so it disappears when the vector
+ is destroyed or the program exits.
+
+ @param element_size  The size of an element in bytes.
+ @param page_bytes    The size of a page in bytes, rounded down to whole elements, or zero for
+                      @c VECTOR_EXTERNAL_DEFAULT_PAGE_BYTES. A page holds at least one element.
+ @param window_pages  The maximum number of pages held in memory, at least 1.
+ @param directory     The directory for the temporary file, or @c NULL for @c $TMPDIR, or @c /tmp
+                      if it is not set.
+
+ @return A new external vector, or @c NULL if memory could not be allocated or the temporary file
+         could not be created.
+ */
+VECTOR_EXTERN vector_external_t *vector_external_create(const size_t element_size, const size_t page_bytes,
+                                                        const size_t window_pages, const char *directory);
+
+/**
+ Destroy an external vector, its temporary file and its memory.
+
+ @param external An external vector.
+ */
+VECTOR_EXTERN void vector_external_destroy(vector_external_t *external);
+
+/**
+ Return an external vector's element size.
+
+ @param external An external vector.
+
+ @return The size of the vector's elements in bytes.
+ */
+VECTOR_EXTERN size_t vector_external_element_size(const vector_external_t *external);
+
+/**
+ Return the number of elements in an external vector.
+
+ @param external An external vector.
+
+ @return The number of elements.
+ */
+VECTOR_EXTERN size_t vector_external_size(const vector_external_t *external);
+
+/**
+ Set how many pages are read ahead when an external vector's pages are read in order.
+
+ @param external An external vector.
+ @param pages    The number of pages to read ahead, or zero to disable read-ahead.
+ */
+VECTOR_EXTERN void vector_external_set_readahead(vector_external_t *external, const size_t pages);
+
+/**
+ Append an element to an external vector.
+
+ @param external An external vector.
+ @param value    A pointer to the element to copy.
+ */
+VECTOR_EXTERN void vector_external_push_back(vector_external_t *external, const void *value);
+
+/**
+ Return a pointer to an element of an external vector, reading its page into memory if needed.
+
+ The pointer is only valid until the next call to a function on the vector, which may evict the
+ page. Use vector_external_set() to change an element.
+
+ @param external An external vector.
+ @param index    The index of the element, less than the vector's size.
+
+ @return A pointer to the element, or @c NULL if its page could not be read and the library's
+         abort() function returned.
+ */
+VECTOR_EXTERN const void *vector_external_get(vector_external_t *external, const size_t index);
+
+/**
+ Set the value of an element of an external vector.
+
+ @param external An external vector.
+ @param index    The index of the element, less than the vector's size.
+ @param value    A pointer to the value to copy.
+ */
+VECTOR_EXTERN void vector_external_set(vector_external_t *external, const size_t index, const void *value);
+
+/**
+ Call a function on the elements of an external vector with indices in [@c first, @c last), in
+ order, in runs of up to a page.
+
+ The function must not call functions on the vector.
+
+ @param external An external vector.
+ @param first    The index of the first element to process.
+ @param last     One past the index of the last element to process, at most the vector's size.
+ @param func     The function to call on each run.
+ @param context  An argument passed to each call of @c func.
+ */
+VECTOR_EXTERN void vector_external_scan(vector_external_t *external, const size_t first, const size_t last,
+                                        const vector_external_scan_func_t func, void *context);
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_gap.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+
+// The elements live in [0, gap_start) and [gap_end, vector_size(buffer)) of the buffer. The buffer
+// is a plain vector so that all allocation goes through the global system functions.
+struct vector_gap_t {
+    vector_t *buffer;
+    size_t gap_start;
+    size_t gap_end;
+};
+
+static inline size_t gap_length(const vector_gap_t *gap) {
+    return gap->gap_end - gap->gap_start;
+}
+
+static inline char *slot(const vector_gap_t *gap, const size_t buffer_index) {
+    return (char *)vector_data(gap->buffer) + buffer_index * vector_element_size(gap->buffer);
+}
+
+static inline char *element(const vector_gap_t *gap, const size_t index) {
+    VECTOR_CHECK(gap && index < vector_gap_size(gap));
+    return slot(gap, index < gap->gap_start ? index : index + gap_length(gap));
+}
+
+static void move_gap(vector_gap_t *gap, const size_t pos) {
+    const size_t element_size = vector_element_size(gap->buffer);
+    if (pos < gap->gap_start) {
+        const size_t count = gap->gap_start - pos;
+        vector_system_memmove(slot(gap, gap->gap_end - count), slot(gap, pos), count * element_size);
+        gap->gap_start -= count;
+        gap->gap_end -= count;
+    } else if (pos > gap->gap_start) {
+        const size_t count = pos - gap->gap_start;
+        vector_system_memmove(slot(gap, gap->gap_start), slot(gap, gap->gap_end), count * element_size);
+        gap->gap_start += count;
+        gap->gap_end += count;
+    }
+    assert(gap->gap_start == pos);
+}
+
+static void grow_gap(vector_gap_t *gap) {
+    const size_t old_total = vector_size(gap->buffer);
+    const size_t tail = old_total - gap->gap_end;
+    const size_t new_total = vector_capacity_for_size(gap->buffer, old_total + 1);
+    vector_resize(gap->buffer, new_total);
+    if (tail > 0) {
+        vector_system_memmove(slot(gap, new_total - tail), slot(gap, gap->gap_end),
+                              tail * vector_element_size(gap->buffer));
+    }
+    gap->gap_end = new_total - tail;
+}
+
+vector_gap_t *vector_gap_create(const size_t element_size) {
+    VECTOR_CHECK(element_size > 0);
+    vector_gap_t *gap = vector_system_realloc(NULL, sizeof(vector_gap_t));
+    if (gap) {
+        gap->buffer = vector_create(element_size);
+        if (!gap->buffer) {
+            vector_system_free(gap);
+            return NULL;
+        }
+        gap->gap_start = 0;
+        gap->gap_end = 0;
+    }
+    return gap;
+}
+
+vector_gap_t *vector_gap_create_with_vector(const vector_t *vector) {
+    VECTOR_CHECK(vector);
+    vector_gap_t *gap = vector_gap_create(vector_element_size(vector));
+    if (gap) {
+        const size_t size = vector_size(vector);
+        vector_resize(gap->buffer, size);
+        vector_system_memcpy(vector_data(gap->buffer), vector_data(vector), size * vector_element_size(vector));
+        gap->gap_start = size;
+        gap->gap_end = size;
+    }
+    return gap;
+}
+
+void vector_gap_destroy(vector_gap_t *gap) {
+    VECTOR_CHECK(gap);
+    vector_destroy(gap->buffer);
+    vector_system_free(gap);
+}
+
+size_t vector_gap_element_size(const vector_gap_t *gap) {
+    VECTOR_CHECK(gap);
+    return vector_element_size(gap->buffer);
+}
+
+bool vector_gap_empty(const vector_gap_t *gap) {
+    VECTOR_CHECK(gap);
+    return vector_gap_size(gap) == 0;
+}
+
+size_t vector_gap_size(const vector_gap_t *gap) {
+    VECTOR_CHECK(gap);
+    return vector_size(gap->buffer) - gap_length(gap);
+}
+
+size_t vector_gap_cursor(const vector_gap_t *gap) {
+    VECTOR_CHECK(gap);
+    return gap->gap_start;
+}
+
+void *vector_gap_get(const vector_gap_t *gap, const size_t index) {
+    return element(gap, index);
+}
+
+void vector_gap_set(vector_gap_t *gap, const size_t index, const void *value) {
+    VECTOR_CHECK(gap && value && index < vector_gap_size(gap));
+    vector_system_memcpy(element(gap, index), value, vector_element_size(gap->buffer));
+}
+
+void vector_gap_insert(vector_gap_t *gap, const size_t pos, const void *value) {
+    VECTOR_CHECK(gap && value && pos <= vector_gap_size(gap));
+    if (pos > vector_gap_size(gap)) {
+        return;
+    }
+    move_gap(gap, pos);
+    if (gap_length(gap) == 0) {
+        grow_gap(gap);
+    }
+    vector_system_memcpy(slot(gap, gap->gap_start), value, vector_element_size(gap->buffer));
+    ++gap->gap_start;
+}
+
+void vector_gap_erase(vector_gap_t *gap, const size_t pos) {
+    VECTOR_CHECK(gap && pos < vector_gap_size(gap));
+    if (pos >= vector_gap_size(gap)) {
+        return;
+    }
+    move_gap(gap, pos);
+    ++gap->gap_end;
+}
+
+vector_t *vector_gap_compact(const vector_gap_t *gap) {
+    VECTOR_CHECK(gap);
+    const size_t element_size = vector_element_size(gap->buffer);
+    const size_t head = gap->gap_start;
+    const size_t tail = vector_size(gap->buffer) - gap->gap_end;
+    vector_t *vector = vector_create_with_size(element_size, head + tail);
+    if (vector) {
+        char *data = vector_data(vector);
+        if (head > 0) {
+            vector_system_memcpy(data, slot(gap, 0), head * element_size);
+        }
+        if (tail > 0) {
+            vector_system_memcpy(data + head * element_size, slot(gap, gap->gap_end), tail * element_size);
+        }
+    }
+    return vector;
+}
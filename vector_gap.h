@@ -0,0 +1,164 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_GAP_H
+#define VECTOR_GAP_H
+
+/**
+ @file vector_gap.h
+
+ A gap buffer of fixed-sized objects for clustered insertions and erasures (optional).
+
+ A gap buffer stores its elements in a single allocation with a movable run of unused slots (the
+ "gap") at the position of the last edit. Inserting or erasing next to the previous edit only moves
+ the elements between the old and new edit positions, so a sequence of edits around a cursor costs
+ amortized O(1) per edit instead of the O(n) tail move of @c vector_insert().
+
+ Elements are not contiguous while a gap is present. Use @c vector_gap_compact() to produce a
+ contiguous @c vector_t.
+ */
+
+#include "vector.h"
+
+/** An anonymous structure for storing a gap buffer's state. */
+struct vector_gap_t;
+
+/** A sequence of fixed-sized members with a movable gap for cheap edits near a cursor. */
+typedef struct vector_gap_t vector_gap_t;
+
+/**
+ Create an empty gap buffer.
+
+ @param element_size The size of an element in bytes.
+
+ @return A new initialized gap buffer.
+ */
+VECTOR_EXTERN vector_gap_t *vector_gap_create(const size_t element_size);
+
+/**
+ Create a gap buffer by copying a vector.
+
+ The gap is initially placed after the last element.
+
+ @param vector The vector to copy.
+
+ @return A new initialized gap buffer with a copy of the elements of @c vector.
+ */
+VECTOR_EXTERN vector_gap_t *vector_gap_create_with_vector(const vector_t *vector);
+
+/**
+ Destroy a gap buffer and deallocate its memory.
+
+ @param gap A gap buffer.
+ */
+VECTOR_EXTERN void vector_gap_destroy(vector_gap_t *gap);
+
+/**
+ Return a gap buffer's element size.
+
+ @param gap A gap buffer.
+
+ @return The size of the gap buffer's elements in bytes.
+ */
+VECTOR_EXTERN size_t vector_gap_element_size(const vector_gap_t *gap);
+
+/**
+ Return if a gap buffer is empty.
+
+ @param gap A gap buffer.
+
+ @return True if the gap buffer is empty.
+ */
+VECTOR_EXTERN bool vector_gap_empty(const vector_gap_t *gap);
+
+/**
+ Return the number of elements in a gap buffer.
+
+ @param gap A gap buffer.
+
+ @return The size of the gap buffer.
+ */
+VECTOR_EXTERN size_t vector_gap_size(const vector_gap_t *gap);
+
+/**
+ Return the index of the gap, i.e. the position at which an insertion moves no elements.
+
+ @param gap A gap buffer.
+
+ @return An index in the range of [0, size].
+ */
+VECTOR_EXTERN size_t vector_gap_cursor(const vector_gap_t *gap);
+
+/**
+ Get an element from a gap buffer.
+
+ The returned pointer is invalidated by any insertion or erasure.
+
+ @param gap   A gap buffer.
+ @param index An index in the range of [0, size - 1].
+
+ @return A pointer to the element.
+ */
+VECTOR_EXTERN void *vector_gap_get(const vector_gap_t *gap, const size_t index);
+
+/**
+ Set an element of a gap buffer.
+
+ @param gap   A gap buffer.
+ @param index An index in the range of [0, size - 1].
+ @param value A pointer to the new value of at least @c element_size bytes.
+ */
+VECTOR_EXTERN void vector_gap_set(vector_gap_t *gap, const size_t index, const void *value);
+
+/**
+ Insert an element into a gap buffer.
+
+ The gap is moved to @c pos first, which moves only the elements between the previous edit
+ position and @c pos. The gap is left directly after the new element, so consecutive insertions
+ at increasing positions move no elements.
+
+ Invalidates element pointers.
+
+ @param gap   A gap buffer.
+ @param pos   The index of the new element.
+ @param value A pointer to the new value of at least @c element_size bytes.
+ */
+VECTOR_EXTERN void vector_gap_insert(vector_gap_t *gap, const size_t pos, const void *value);
+
+/**
+ Erase an element of a gap buffer, decreasing its size by one.
+
+ The gap is moved to @c pos first and then widened over the erased element.
+
+ Invalidates element pointers.
+
+ @param gap A gap buffer.
+ @param pos The index of the element to erase.
+ */
+VECTOR_EXTERN void vector_gap_erase(vector_gap_t *gap, const size_t pos);
+
+/**
+ Copy the elements of a gap buffer into a new contiguous vector.
+
+ The gap buffer is not modified.
+
+ @param gap A gap buffer.
+
+ @return A new initialized vector with a copy of the elements of @c gap in order.
+ */
+VECTOR_EXTERN vector_t *vector_gap_compact(const vector_gap_t *gap);
+
+#endif
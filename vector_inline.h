@@ -0,0 +1,97 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_INLINE_H
+#define VECTOR_INLINE_H
+
+/**
+ @file vector_inline.h
+
+ Inline versions of the most common accessors (optional).
+
+ @c vector.h keeps @c vector_t opaque, so even trivial accessors are function calls. Including this
+ header exposes the structure's layout and provides @c static @c inline versions of
+ @c vector_get(), @c vector_size(), @c vector_data(), @c vector_front(), @c vector_back() and of
+ @c vector_push_back() when no growth is needed, which lets the compiler inline them and vectorize
+ loops that use them.
+
+ The price is that code including this header depends on the layout of @c vector_t and must be
+ compiled against the same version of the library that it links to. The inline functions check
+ their arguments with @c VECTOR_CHECK() at the checking level of the including translation unit.
+ */
+
+#include <string.h>
+
+#include "vector.h"
+#include "vector_check.h"
+
+/** The layout of a vector. The fields must not be modified directly. */
+struct vector_t {
+    size_t element_size;                    /**< The size of each element in bytes. */
+    size_t size;                            /**< The number of elements. */
+    size_t capacity;                        /**< The number of elements the storage has room for. */
+    float expansion_factor;                 /**< How much the capacity grows when appending. */
+    vector_element_funcs_t element_funcs;   /**< Functions for elements that own resources. */
+    void *data;                             /**< The storage, or @c NULL if the capacity is zero. */
+};
+
+/** Inline version of @c vector_size(). */
+static inline size_t vector_inline_size(const vector_t *vector) {
+    VECTOR_CHECK(vector);
+    return vector->size;
+}
+
+/** Inline version of @c vector_data(). */
+static inline void *vector_inline_data(const vector_t *vector) {
+    VECTOR_CHECK(vector);
+    return vector->data;
+}
+
+/** Inline version of @c vector_get(). */
+static inline void *vector_inline_get(const vector_t *vector, const size_t index) {
+    VECTOR_CHECK(vector && index < vector->size);
+    return (char *)vector->data + index * vector->element_size;
+}
+
+/** Inline version of @c vector_front(). */
+static inline void *vector_inline_front(const vector_t *vector) {
+    VECTOR_CHECK(vector && vector->size >= 1);
+    return vector->data;
+}
+
+/** Inline version of @c vector_back(). */
+static inline void *vector_inline_back(const vector_t *vector) {
+    VECTOR_CHECK(vector && vector->size >= 1);
+    return (char *)vector->data + (vector->size - 1) * vector->element_size;
+}
+
+/**
+ Inline version of @c vector_push_back().
+
+ If the vector has spare capacity and no copy function, the value is copied inline with memcpy()
+ rather than the library's memcpy() function. Otherwise this calls @c vector_push_back().
+ */
+static inline void vector_inline_push_back(vector_t *vector, const void *value) {
+    VECTOR_CHECK(vector && value);
+    if (vector->size < vector->capacity && !vector->element_funcs.copy) {
+        memcpy((char *)vector->data + vector->size * vector->element_size, value, vector->element_size);
+        ++vector->size;
+    } else {
+        vector_push_back(vector, value);
+    }
+}
+
+#endif
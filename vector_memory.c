@@ -0,0 +1,162 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector_memory.h"
+#include "vector_atomic.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#   define VECTOR_MEMORY_X86 1
+#   include <immintrin.h>
+#else
+#   define VECTOR_MEMORY_X86 0
+#endif
+
+static const size_t DEFAULT_STREAMING_THRESHOLD = 8 * 1024 * 1024;
+static const size_t SMALL_COPY_LIMIT = 64;
+
+// Zero until first use, when it is set to the detected last-level cache size. Copies on any thread
+// read it, so it is only accessed atomically.
+static size_t streaming_threshold = 0;
+
+// Copy up to 64 bytes. All loads happen before any stores, so the ranges may overlap. The
+// fixed-size memcpy() calls compile to single unaligned loads and stores.
+static inline void copy_small(char *dst, const char *src, const size_t n) {
+    if (n >= 32) {
+        char head[32], tail[32];
+        memcpy(head, src, 32);
+        memcpy(tail, src + n - 32, 32);
+        memcpy(dst, head, 32);
+        memcpy(dst + n - 32, tail, 32);
+    } else if (n >= 16) {
+        char head[16], tail[16];
+        memcpy(head, src, 16);
+        memcpy(tail, src + n - 16, 16);
+        memcpy(dst, head, 16);
+        memcpy(dst + n - 16, tail, 16);
+    } else if (n >= 8) {
+        uint64_t head, tail;
+        memcpy(&head, src, 8);
+        memcpy(&tail, src + n - 8, 8);
+        memcpy(dst, &head, 8);
+        memcpy(dst + n - 8, &tail, 8);
+    } else if (n >= 4) {
+        uint32_t head, tail;
+        memcpy(&head, src, 4);
+        memcpy(&tail, src + n - 4, 4);
+        memcpy(dst, &head, 4);
+        memcpy(dst + n - 4, &tail, 4);
+    } else if (n > 0) {
+        const char first = src[0];
+        const char middle = src[n / 2];
+        const char last = src[n - 1];
+        dst[0] = first;
+        dst[n / 2] = middle;
+        dst[n - 1] = last;
+    }
+}
+
+#if VECTOR_MEMORY_X86
+
+// Copy with non-temporal stores of BLOCK bytes. The destination is aligned with an ordinary copy of
+// the head, and the unaligned tail is copied ordinarily as well.
+#define STREAMING_COPY(name, target, BLOCK, V, LOAD, STREAM) \
+    target static void name(char *dst, const char *src, size_t n) { \
+        const size_t misalignment = (uintptr_t)dst & ((BLOCK) - 1); \
+        if (misalignment) { \
+            const size_t head = (BLOCK) - misalignment; \
+            memcpy(dst, src, head); \
+            dst += head; \
+            src += head; \
+            n -= head; \
+        } \
+        for (; n >= (BLOCK); n -= (BLOCK), dst += (BLOCK), src += (BLOCK)) { \
+            STREAM((V *)dst, LOAD((const V *)src)); \
+        } \
+        _mm_sfence(); \
+        memcpy(dst, src, n); \
+    }
+
+STREAMING_COPY(copy_streaming_sse2, __attribute__((target("sse2"))), 16, __m128i, _mm_loadu_si128, _mm_stream_si128)
+STREAMING_COPY(copy_streaming_avx2, __attribute__((target("avx2"))), 32, __m256i, _mm256_loadu_si256, _mm256_stream_si256)
+
+static bool copy_streaming(char *dst, const char *src, const size_t n) {
+    if (__builtin_cpu_supports("avx2")) {
+        copy_streaming_avx2(dst, src, n);
+        return true;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        copy_streaming_sse2(dst, src, n);
+        return true;
+    }
+    return false;
+}
+
+#else
+
+static bool copy_streaming(char *dst, const char *src, const size_t n) {
+    return false;
+}
+
+#endif
+
+void *vector_tuned_memcpy_func(void *restrict dst, const void *restrict src, size_t n) {
+    if (n <= SMALL_COPY_LIMIT) {
+        copy_small(dst, src, n);
+        return dst;
+    }
+    if (n >= vector_streaming_threshold() && copy_streaming(dst, src, n)) {
+        return dst;
+    }
+    return memcpy(dst, src, n);
+}
+
+void *vector_tuned_memmove_func(void *dst, const void *src, size_t len) {
+    if (len <= SMALL_COPY_LIMIT) {
+        copy_small(dst, src, len);
+        return dst;
+    }
+    const char *d = dst;
+    const char *s = src;
+    if (d + len <= s || s + len <= d) {
+        return vector_tuned_memcpy_func(dst, src, len);
+    }
+    return memmove(dst, src, len);
+}
+
+size_t vector_streaming_threshold(void) {
+    size_t threshold = VECTOR_ATOMIC_LOAD_RELAXED(&streaming_threshold);
+    if (threshold == 0) {
+        long cache_size = -1;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+        cache_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+        // Keep a value set by another thread in the meantime.
+        size_t expected = 0;
+        const size_t detected = cache_size > 0 ? (size_t)cache_size : DEFAULT_STREAMING_THRESHOLD;
+        threshold = VECTOR_ATOMIC_COMPARE_EXCHANGE(&streaming_threshold, &expected, detected) ? detected : expected;
+    }
+    return threshold;
+}
+
+void vector_set_streaming_threshold(const size_t threshold) {
+    VECTOR_ATOMIC_STORE_RELAXED(&streaming_threshold, threshold > 0 ? threshold : 1);
+}
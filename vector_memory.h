@@ -0,0 +1,72 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_MEMORY_H
+#define VECTOR_MEMORY_H
+
+/**
+ @file vector_memory.h
+
+ Memory copy functions tuned for vector workloads (optional).
+
+ The functions in this file are drop-in replacements for the default memcpy() and memmove()
+ functions in @c vector_system.h. Install them with @c vector_set_global_memcpy_func() and
+ @c vector_set_global_memmove_func().
+
+ They differ from the system functions in two ways:
+
+ - Copies of up to 64 bytes, e.g. single elements, are done inline with a few overlapping loads and
+   stores instead of a call into the C library.
+ - Copies of at least the streaming threshold, by default the size of the last-level cache, use
+   non-temporal stores on x86 so that copying a large vector does not evict the rest of the working
+   set from the cache.
+ */
+
+#include "vector_system.h"
+
+/**
+ A memcpy() replacement tuned for vector workloads.
+
+ Suitable for @c vector_set_global_memcpy_func().
+ */
+VECTOR_EXTERN void *vector_tuned_memcpy_func(void *restrict dst, const void *restrict src, size_t n);
+
+/**
+ A memmove() replacement tuned for vector workloads.
+
+ Non-overlapping moves are handled by @c vector_tuned_memcpy_func(). Suitable for
+ @c vector_set_global_memmove_func().
+ */
+VECTOR_EXTERN void *vector_tuned_memmove_func(void *dst, const void *src, size_t len);
+
+/**
+ Return the copy size at which the tuned functions switch to non-temporal stores.
+
+ Unless set with @c vector_set_streaming_threshold(), this is the size of the last-level cache if
+ the system reports it, and 8 MiB otherwise.
+
+ @return A size in bytes.
+ */
+VECTOR_EXTERN size_t vector_streaming_threshold(void);
+
+/**
+ Set the copy size at which the tuned functions switch to non-temporal stores.
+
+ @param threshold A size in bytes, or @c SIZE_MAX to never use non-temporal stores.
+ */
+VECTOR_EXTERN void vector_set_streaming_threshold(const size_t threshold);
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector_mpsc.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+
+// Producers are padded apart so that one producer's appends do not invalidate the cache line
+// holding another producer's lock and staging vector.
+#define CACHE_LINE_SIZE 64
+
+struct vector_mpsc_producer_t {
+    pthread_mutex_t lock;                   // Guards staging against the consumer's swap.
+    vector_t *staging;                      // Where the producer appends.
+    vector_t *draining;                     // The consumer's side of the swap, empty between drains.
+    struct vector_mpsc_t *mpsc;
+    struct vector_mpsc_producer_t *next;
+    char padding[CACHE_LINE_SIZE];
+};
+
+struct vector_mpsc_t {
+    size_t element_size;
+    pthread_mutex_t lock;                   // Guards the list of producers and retired.
+    vector_mpsc_producer_t *first;          // The producers in the order they were created.
+    vector_mpsc_producer_t *last;
+    vector_t *retired;                      // Elements left behind by destroyed producers.
+};
+
+// Move all of source's elements to the end of destination, leaving source empty. Returns the
+// number of elements moved, which is zero if destination could not grow.
+static size_t move_elements(vector_t *destination, vector_t *source) {
+    const size_t count = vector_size(source);
+    if (count == 0) {
+        return 0;
+    }
+    if (vector_empty(destination) && vector_capacity(destination) < count) {
+        const float expansion_factor = vector_expansion_factor(destination);
+        vector_swap(destination, source);
+        vector_set_expansion_factor(source, vector_expansion_factor(destination));
+        vector_set_expansion_factor(destination, expansion_factor);
+        return count;
+    }
+    void *elements = vector_emplace_back_n(destination, count);
+    if (!elements) {
+        return 0;
+    }
+    vector_system_memcpy(elements, vector_data(source), count * vector_element_size(source));
+    vector_clear(source);
+    return count;
+}
+
+vector_mpsc_t *vector_mpsc_create(const size_t element_size) {
+    VECTOR_CHECK(element_size > 0);
+    vector_mpsc_t *mpsc = vector_system_realloc(NULL, sizeof(vector_mpsc_t));
+    if (mpsc) {
+        mpsc->retired = vector_create(element_size);
+        if (!mpsc->retired) {
+            vector_system_free(mpsc);
+            return NULL;
+        }
+        mpsc->element_size = element_size;
+        pthread_mutex_init(&mpsc->lock, NULL);
+        mpsc->first = NULL;
+        mpsc->last = NULL;
+    }
+    return mpsc;
+}
+
+void vector_mpsc_destroy(vector_mpsc_t *mpsc) {
+    VECTOR_CHECK(mpsc);
+    for (vector_mpsc_producer_t *producer = mpsc->first; producer;) {
+        vector_mpsc_producer_t *next = producer->next;
+        pthread_mutex_destroy(&producer->lock);
+        vector_destroy(producer->staging);
+        vector_destroy(producer->draining);
+        vector_system_free(producer);
+        producer = next;
+    }
+    vector_destroy(mpsc->retired);
+    pthread_mutex_destroy(&mpsc->lock);
+    vector_system_free(mpsc);
+}
+
+vector_mpsc_producer_t *vector_mpsc_producer_create(vector_mpsc_t *mpsc) {
+    VECTOR_CHECK(mpsc);
+    vector_mpsc_producer_t *producer = vector_system_realloc(NULL, sizeof(vector_mpsc_producer_t));
+    if (!producer) {
+        return NULL;
+    }
+    producer->staging = vector_create(mpsc->element_size);
+    producer->draining = vector_create(mpsc->element_size);
+    if (!producer->staging || !producer->draining) {
+        if (producer->staging) {
+            vector_destroy(producer->staging);
+        }
+        if (producer->draining) {
+            vector_destroy(producer->draining);
+        }
+        vector_system_free(producer);
+        return NULL;
+    }
+    pthread_mutex_init(&producer->lock, NULL);
+    producer->mpsc = mpsc;
+    producer->next = NULL;
+
+    pthread_mutex_lock(&mpsc->lock);
+    if (mpsc->last) {
+        mpsc->last->next = producer;
+    } else {
+        mpsc->first = producer;
+    }
+    mpsc->last = producer;
+    pthread_mutex_unlock(&mpsc->lock);
+    return producer;
+}
+
+void vector_mpsc_producer_destroy(vector_mpsc_producer_t *producer) {
+    VECTOR_CHECK(producer);
+    vector_mpsc_t *mpsc = producer->mpsc;
+    pthread_mutex_lock(&mpsc->lock);
+    vector_mpsc_producer_t *previous = NULL;
+    for (vector_mpsc_producer_t *p = mpsc->first; p != producer; p = p->next) {
+        previous = p;
+    }
+    if (previous) {
+        previous->next = producer->next;
+    } else {
+        mpsc->first = producer->next;
+    }
+    if (mpsc->last == producer) {
+        mpsc->last = previous;
+    }
+
+    // Keep the undrained elements, oldest first. If they cannot be kept, they are lost.
+    move_elements(mpsc->retired, producer->draining);
+    move_elements(mpsc->retired, producer->staging);
+    pthread_mutex_unlock(&mpsc->lock);
+
+    pthread_mutex_destroy(&producer->lock);
+    vector_destroy(producer->staging);
+    vector_destroy(producer->draining);
+    vector_system_free(producer);
+}
+
+void vector_mpsc_push(vector_mpsc_producer_t *producer, const void *value) {
+    VECTOR_CHECK(producer && value);
+    pthread_mutex_lock(&producer->lock);
+    vector_push_back(producer->staging, value);
+    pthread_mutex_unlock(&producer->lock);
+}
+
+void vector_mpsc_push_n(vector_mpsc_producer_t *producer, const void *values, const size_t count) {
+    VECTOR_CHECK(producer && (values || count == 0));
+    pthread_mutex_lock(&producer->lock);
+    void *elements = vector_emplace_back_n(producer->staging, count);
+    if (elements) {
+        vector_system_memcpy(elements, values, count * vector_element_size(producer->staging));
+    }
+    pthread_mutex_unlock(&producer->lock);
+}
+
+size_t vector_mpsc_drain(vector_mpsc_t *mpsc, vector_t *out) {
+    VECTOR_CHECK(mpsc && out && vector_element_size(out) == mpsc->element_size);
+    VECTOR_CHECK(!vector_element_funcs(out)->copy && !vector_element_funcs(out)->move &&
+                 !vector_element_funcs(out)->destroy);
+
+    pthread_mutex_lock(&mpsc->lock);
+    size_t count = move_elements(out, mpsc->retired);
+    bool full = !vector_empty(mpsc->retired);
+    for (vector_mpsc_producer_t *producer = mpsc->first; producer && !full; producer = producer->next) {
+        // A draining vector that is not empty holds elements a previous drain could not move, which
+        // are older than the staged ones.
+        if (vector_empty(producer->draining)) {
+            pthread_mutex_lock(&producer->lock);
+            vector_swap(producer->staging, producer->draining);
+            pthread_mutex_unlock(&producer->lock);
+        }
+        count += move_elements(out, producer->draining);
+        full = !vector_empty(producer->draining);
+    }
+    pthread_mutex_unlock(&mpsc->lock);
+    return count;
+}
@@ -0,0 +1,119 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_MPSC_H
+#define VECTOR_MPSC_H
+
+/**
+ @file vector_mpsc.h
+
+ A buffer that many threads append to and one thread drains in batches (optional, requires POSIX
+ threads).
+
+ Each producer thread appends through its own @c vector_mpsc_producer_t, which owns a private
+ staging vector, so producers never wait for each other. The consumer drains the buffer by swapping
+ each producer's staging vector for an empty one, which holds the producer's lock for only a few
+ instructions, and then copies the swapped-out elements into its own vector in bulk.
+
+ Elements from one producer are drained in the order they were appended. There is no order between
+ elements of different producers. Elements are moved bytewise, so the buffer cannot hold elements
+ that need element functions (see @c vector_set_element_funcs()).
+ */
+
+#include "vector.h"
+
+/** An anonymous structure for storing a multi-producer buffer's state. */
+struct vector_mpsc_t;
+
+/** A buffer that many threads append to and one thread drains. */
+typedef struct vector_mpsc_t vector_mpsc_t;
+
+/** An anonymous structure for storing one producer's state. */
+struct vector_mpsc_producer_t;
+
+/** One thread's handle for appending to a @c vector_mpsc_t. */
+typedef struct vector_mpsc_producer_t vector_mpsc_producer_t;
+
+/**
+ Create an empty multi-producer buffer.
+
+ @param element_size The size of an element in bytes.
+
+ @return A new buffer without producers, or @c NULL if memory could not be allocated.
+ */
+VECTOR_EXTERN vector_mpsc_t *vector_mpsc_create(const size_t element_size);
+
+/**
+ Destroy a buffer, its remaining producers and any elements not yet drained.
+
+ @param mpsc A buffer that no thread is using.
+ */
+VECTOR_EXTERN void vector_mpsc_destroy(vector_mpsc_t *mpsc);
+
+/**
+ Add a producer to a buffer.
+
+ A producer must only be used by one thread at a time, usually the thread that created it.
+
+ @param mpsc A buffer.
+
+ @return A new producer, or @c NULL if memory could not be allocated.
+ */
+VECTOR_EXTERN vector_mpsc_producer_t *vector_mpsc_producer_create(vector_mpsc_t *mpsc);
+
+/**
+ Remove a producer from its buffer and destroy it.
+
+ Elements the producer appended that have not been drained stay in the buffer and are returned by
+ the next drain.
+
+ @param producer A producer.
+ */
+VECTOR_EXTERN void vector_mpsc_producer_destroy(vector_mpsc_producer_t *producer);
+
+/**
+ Append an element to a buffer through a producer.
+
+ @param producer A producer.
+ @param value    A pointer to the element to copy.
+ */
+VECTOR_EXTERN void vector_mpsc_push(vector_mpsc_producer_t *producer, const void *value);
+
+/**
+ Append several elements to a buffer through a producer.
+
+ @param producer A producer.
+ @param values   A pointer to the elements to copy.
+ @param count    The number of elements.
+ */
+VECTOR_EXTERN void vector_mpsc_push_n(vector_mpsc_producer_t *producer, const void *values, const size_t count);
+
+/**
+ Move every element appended so far from a buffer to the end of a vector.
+
+ Producers may keep appending while the buffer is drained; elements appended during the drain may
+ or may not be included. If @c out is empty, a producer's elements are moved by swapping storage
+ with @c out instead of copying. If @c out cannot grow, the remaining elements stay in the buffer.
+ Only one thread at a time may drain a buffer.
+
+ @param mpsc A buffer.
+ @param out  A vector with the buffer's element size and without element functions.
+
+ @return The number of elements appended to @c out.
+ */
+VECTOR_EXTERN size_t vector_mpsc_drain(vector_mpsc_t *mpsc, vector_t *out);
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#define _GNU_SOURCE
+
+#include "vector_numa.h"
+#include "vector_check.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_get_mempolicy)
+#   define HAVE_MEMPOLICY 1
+#else
+#   define HAVE_MEMPOLICY 0
+#endif
+
+// Values from the kernel's uapi/linux/mempolicy.h, which is not always installed.
+#define MPOL_PREFERRED 1
+#define MPOL_INTERLEAVE 3
+#define MPOL_F_NODE (1 << 0)
+#define MPOL_F_ADDR (1 << 1)
+#define MPOL_F_MEMS_ALLOWED (1 << 2)
+
+// Node masks cover this many nodes. The kernel reads one less bit than the maximum node it is told,
+// so the system calls are passed MAX_NODES + 1.
+#define MAX_NODES 1024
+#define BITS_PER_WORD (8 * sizeof(unsigned long))
+
+// Every allocation starts with a header holding its usable capacity, and the size of its mapping
+// if it was mapped from the kernel rather than allocated with malloc(). The union keeps the memory
+// that follows it aligned as well as the system allocator aligns it.
+typedef union header_t {
+    struct {
+        size_t capacity;
+        size_t mapped;
+    } info;
+    long double align_long_double;
+    long long align_long_long;
+    void *align_pointer;
+} header_t;
+
+typedef struct thread_policy_t {
+    vector_numa_policy_t policy;
+    int node;
+} thread_policy_t;
+
+static VECTOR_THREAD_LOCAL thread_policy_t thread_policy;
+
+static inline header_t *header(void *ptr) {
+    return (header_t *)ptr - 1;
+}
+
+// Fill mask with the nodes the process may allocate on. Returns false if NUMA is not supported.
+static bool allowed_nodes(unsigned long mask[MAX_NODES / BITS_PER_WORD]) {
+    memset(mask, 0, MAX_NODES / 8);
+#if HAVE_MEMPOLICY
+    int mode;
+    return syscall(SYS_get_mempolicy, &mode, mask, MAX_NODES + 1, NULL, MPOL_F_MEMS_ALLOWED) == 0;
+#else
+    return false;
+#endif
+}
+
+// Apply the calling thread's policy to a mapping. Placement is advisory, so failures are ignored.
+static void apply_policy(void *address, const size_t length) {
+#if HAVE_MEMPOLICY
+    unsigned long mask[MAX_NODES / BITS_PER_WORD];
+    int mode;
+    switch (thread_policy.policy) {
+        case VECTOR_NUMA_INTERLEAVE:
+            if (!allowed_nodes(mask)) {
+                return;
+            }
+            mode = MPOL_INTERLEAVE;
+            break;
+        case VECTOR_NUMA_PREFERRED:
+            if (thread_policy.node < 0 || thread_policy.node >= MAX_NODES) {
+                return;
+            }
+            memset(mask, 0, sizeof(mask));
+            mask[thread_policy.node / BITS_PER_WORD] = 1UL << (thread_policy.node % BITS_PER_WORD);
+            mode = MPOL_PREFERRED;
+            break;
+        default:
+            return;
+    }
+    syscall(SYS_mbind, address, length, mode, mask, MAX_NODES + 1, 0);
+#else
+    (void)address;
+    (void)length;
+#endif
+}
+
+static size_t page_size(void) {
+    const long page_size = sysconf(_SC_PAGESIZE);
+    return page_size > 0 ? (size_t)page_size : 4096;
+}
+
+static void *allocate(const size_t size) {
+    if (size < VECTOR_NUMA_MIN_BYTES) {
+        header_t *block = malloc(sizeof(header_t) + size);
+        if (!block) {
+            return NULL;
+        }
+        block->info.capacity = size;
+        block->info.mapped = 0;
+        return block + 1;
+    }
+
+    const size_t page = page_size();
+    if (size > SIZE_MAX - sizeof(header_t) - page) {
+        return NULL;
+    }
+    const size_t mapped = (sizeof(header_t) + size + page - 1) / page * page;
+    void *mapping = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    apply_policy(mapping, mapped);
+    header_t *block = mapping;
+    block->info.capacity = mapped - sizeof(header_t);
+    block->info.mapped = mapped;
+    return block + 1;
+}
+
+size_t vector_numa_node_count(void) {
+    unsigned long mask[MAX_NODES / BITS_PER_WORD];
+    if (!allowed_nodes(mask)) {
+        return 1;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < MAX_NODES / BITS_PER_WORD; ++i) {
+        for (unsigned long word = mask[i]; word; word &= word - 1) {
+            ++count;
+        }
+    }
+    return count > 0 ? count : 1;
+}
+
+int vector_numa_node_of(const void *address) {
+#if HAVE_MEMPOLICY
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, address, MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+        return node;
+    }
+#else
+    (void)address;
+#endif
+    return -1;
+}
+
+void vector_numa_set_policy(const vector_numa_policy_t policy, const int node) {
+    VECTOR_CHECK(policy == VECTOR_NUMA_DEFAULT || policy == VECTOR_NUMA_INTERLEAVE ||
+                 policy == VECTOR_NUMA_PREFERRED);
+    thread_policy.policy = policy;
+    thread_policy.node = node;
+}
+
+void *vector_numa_realloc_func(void *ptr, size_t size) {
+    if (size == 0) {
+        vector_numa_free_func(ptr);
+        return NULL;
+    }
+    if (!ptr) {
+        return allocate(size);
+    }
+
+    header_t *old_block = header(ptr);
+    const size_t old_capacity = old_block->info.capacity;
+    if (!old_block->info.mapped && size < VECTOR_NUMA_MIN_BYTES) {
+        header_t *block = realloc(old_block, sizeof(header_t) + size);
+        if (!block) {
+            return NULL;
+        }
+        block->info.capacity = size;
+        return block + 1;
+    }
+    // Keep a mapping that is shrunk by less than half.
+    if (old_block->info.mapped && size <= old_capacity && size > old_capacity / 2) {
+        return ptr;
+    }
+
+    void *new_ptr = allocate(size);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, old_capacity < size ? old_capacity : size);
+        vector_numa_free_func(ptr);
+    }
+    return new_ptr;
+}
+
+bool vector_numa_try_expand_func(void *ptr, size_t size) {
+    header_t *block = header(ptr);
+    if (block->info.capacity >= size) {
+        return true;
+    }
+#if defined(__linux__)
+    // Without MREMAP_MAYMOVE the mapping is only ever extended in place.
+    const size_t page = page_size();
+    if (block->info.mapped && size <= SIZE_MAX - sizeof(header_t) - page) {
+        const size_t mapped = (sizeof(header_t) + size + page - 1) / page * page;
+        if (mremap(block, block->info.mapped, mapped, 0) != MAP_FAILED) {
+            block->info.capacity = mapped - sizeof(header_t);
+            block->info.mapped = mapped;
+            return true;
+        }
+    }
+#endif
+    return false;
+}
+
+void vector_numa_free_func(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    header_t *block = header(ptr);
+    if (block->info.mapped) {
+        munmap(block, block->info.mapped);
+    } else {
+        free(block);
+    }
+}
+
+// First touch
+
+typedef struct touch_t {
+    char *data;
+    size_t element_size;
+    size_t old_size;
+    size_t size;
+} touch_t;
+
+// Zero the new elements in this thread's share of the vector, which matches the range that
+// vector_parallel_for() starts the thread on.
+static void touch_share(void *context, const size_t thread, const size_t nthreads) {
+    const touch_t *touch = context;
+    const size_t size = touch->size;
+    size_t begin = size / nthreads * thread + (thread < size % nthreads ? thread : size % nthreads);
+    const size_t end = size / nthreads * (thread + 1) + (thread + 1 < size % nthreads ? thread + 1 : size % nthreads);
+    begin = begin > touch->old_size ? begin : touch->old_size;
+    if (begin < end) {
+        memset(touch->data + begin * touch->element_size, 0, (end - begin) * touch->element_size);
+    }
+}
+
+void vector_numa_first_touch(vector_t *vector, const size_t size, vector_pool_t *pool) {
+    VECTOR_CHECK(vector && pool && size >= vector_size(vector));
+    VECTOR_CHECK(!vector_element_funcs(vector)->copy && !vector_element_funcs(vector)->move &&
+                 !vector_element_funcs(vector)->destroy);
+    touch_t touch;
+    touch.old_size = vector_size(vector);
+    if (size <= touch.old_size) {
+        return;
+    }
+    vector_resize(vector, size);
+    if (vector_size(vector) != size) {
+        return;
+    }
+    touch.data = vector_data(vector);
+    touch.element_size = vector_element_size(vector);
+    touch.size = size;
+    vector_pool_run(pool, touch_share, &touch);
+}
@@ -0,0 +1,143 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_NUMA_H
+#define VECTOR_NUMA_H
+
+/**
+ @file vector_numa.h
+
+ Placement of large vectors' memory on NUMA nodes (optional, requires POSIX threads).
+
+ On machines with several memory nodes, the kernel places each page of memory on the node of the
+ thread that first writes to it. A large vector that is allocated and filled on one thread
+ therefore lives entirely on one node, and threads on other nodes that scan it pay for remote
+ memory accesses. This file offers two remedies:
+
+ - @c vector_numa_realloc_func() and @c vector_numa_free_func() map allocations of at least
+   @c VECTOR_NUMA_MIN_BYTES directly from the kernel, and apply the calling thread's placement
+   policy from @c vector_numa_set_policy() to them: interleaved across all nodes, or preferring
+   one node. Smaller allocations go to the system allocator.
+
+ - @c vector_numa_first_touch() grows a vector and zeroes the new elements from a thread pool's
+   threads, each writing the part of the vector that @c vector_parallel_for() starts it on, so that
+   with the default policy each part lands on the node of the thread that will process it.
+
+ To use the allocation functions, install them before the library allocates anything:
+
+ @code
+ vector_set_global_realloc_func(vector_numa_realloc_func);
+ vector_set_global_free_func(vector_numa_free_func);
+ vector_set_global_try_expand_func(vector_numa_try_expand_func);
+ vector_numa_set_policy(VECTOR_NUMA_INTERLEAVE, 0);
+ vector_reserve(vector, 1 << 28);
+ @endcode
+
+ Placement uses the Linux @c mbind() and @c get_mempolicy() system calls directly, without
+ libnuma. On other systems, and on kernels without NUMA support, the policies have no effect.
+ */
+
+#include "vector.h"
+#include "vector_pool.h"
+
+/** The smallest allocation, in bytes, that vector_numa_realloc_func() places with a policy. */
+#define VECTOR_NUMA_MIN_BYTES ((size_t)1 << 21)
+
+/** Where the pages of new allocations are placed. */
+typedef enum vector_numa_policy_t {
+    VECTOR_NUMA_DEFAULT,        /**< On the node of the thread that first writes to each page. */
+    VECTOR_NUMA_INTERLEAVE,     /**< Round-robin across all nodes the process may use. */
+    VECTOR_NUMA_PREFERRED,      /**< On a given node, or elsewhere if it is out of memory. */
+} vector_numa_policy_t;
+
+/**
+ Return the number of memory nodes the process may allocate on.
+
+ @return The number of nodes, or 1 if NUMA is not supported.
+ */
+VECTOR_EXTERN size_t vector_numa_node_count(void);
+
+/**
+ Return the node that holds the page containing an address.
+
+ @param address An address in memory that has been written to.
+
+ @return The node holding the page, or -1 if it cannot be determined.
+ */
+VECTOR_EXTERN int vector_numa_node_of(const void *address);
+
+/**
+ Set the placement policy for allocations made by vector_numa_realloc_func() on the calling thread.
+
+ The policy applies when an allocation is made or moved, not to existing allocations. Each thread
+ starts with @c VECTOR_NUMA_DEFAULT.
+
+ @param policy The policy.
+ @param node   The node for @c VECTOR_NUMA_PREFERRED, ignored otherwise.
+ */
+VECTOR_EXTERN void vector_numa_set_policy(const vector_numa_policy_t policy, const int node);
+
+/**
+ A realloc() function that places large allocations with the calling thread's policy.
+
+ Suitable for vector_set_global_realloc_func(). Allocations of at least @c VECTOR_NUMA_MIN_BYTES
+ are mapped from the kernel in whole pages, which are not touched until the vector writes to them.
+ Reallocating to zero bytes frees the allocation and returns @c NULL.
+
+ @param ptr  An allocation from this function, or @c NULL.
+ @param size The requested size in bytes.
+ @return The allocation, or @c NULL if the allocation failed or @p size is zero.
+ */
+VECTOR_EXTERN void *vector_numa_realloc_func(void *ptr, size_t size);
+
+/**
+ A try-expand function for allocations from vector_numa_realloc_func().
+
+ Suitable for vector_set_global_try_expand_func(). Succeeds if the allocation already holds
+ @p size bytes. On Linux, a mapped allocation is also grown by extending its mapping with
+ @c mremap() if the address space after it is free; the new pages get the policy of the mapping.
+
+ @param ptr  An allocation from vector_numa_realloc_func().
+ @param size The number of bytes the allocation needs to hold.
+ @return @c true if the allocation holds at least @p size bytes.
+ */
+VECTOR_EXTERN bool vector_numa_try_expand_func(void *ptr, size_t size);
+
+/**
+ A free() function for allocations from vector_numa_realloc_func().
+
+ Suitable for vector_set_global_free_func().
+
+ @param ptr An allocation from vector_numa_realloc_func(), or @c NULL.
+ */
+VECTOR_EXTERN void vector_numa_free_func(void *ptr);
+
+/**
+ Resize a vector, zeroing the new elements in parallel so that their pages are placed near the
+ threads that will process them.
+
+ The new elements are split between the pool's threads the same way @c vector_parallel_for()
+ initially splits the whole vector, and each thread zeroes its share. This only places pages that
+ have not been written to yet, so reserve the capacity in a fresh allocation first, e.g. with
+ vector_reserve() on an empty vector. The vector must not have element functions.
+
+ @param vector A vector.
+ @param size   The new size, at least the current size.
+ @param pool   The thread pool that will process the vector.
+ */
+VECTOR_EXTERN void vector_numa_first_touch(vector_t *vector, const size_t size, vector_pool_t *pool);
+
+#endif
@@ -0,0 +1,512 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_parallel.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Below this many elements per thread, extra threads cost more than they save.
+static const size_t MIN_ELEMENTS_PER_THREAD = 4096;
+
+// Per-thread accumulators are padded to multiples of this so that no two share a cache line.
+#define CACHE_LINE_SIZE 64
+
+// Running numbered tasks on a thread pool, with each of its threads taking every nthreads-th task.
+
+typedef void (*task_func_t)(void *context, size_t task);
+
+typedef struct pool_tasks_t {
+    task_func_t func;
+    void *context;
+    size_t count;
+} pool_tasks_t;
+
+static void run_pool_thread(void *context, const size_t thread, const size_t nthreads) {
+    const pool_tasks_t *tasks = context;
+    for (size_t task = thread; task < tasks->count; task += nthreads) {
+        tasks->func(tasks->context, task);
+    }
+}
+
+static void run_pool_tasks(vector_pool_t *pool, const size_t count, const task_func_t func, void *context) {
+    pool_tasks_t tasks = { func, context, count };
+    vector_pool_run(pool, run_pool_thread, &tasks);
+}
+
+// The number of threads to use for size elements when nthreads are available.
+static size_t thread_count(const size_t nthreads, const size_t size) {
+    const size_t useful = size / MIN_ELEMENTS_PER_THREAD;
+    return useful < nthreads ? (useful > 0 ? useful : 1) : nthreads;
+}
+
+// Split size items into blocks equal to within one item and return the start of a block.
+static inline size_t split(const size_t size, const size_t blocks, const size_t block) {
+    return size / blocks * block + (block < size % blocks ? block : size % blocks);
+}
+
+// Sorting
+
+typedef struct merge_task_t {
+    size_t first;           // The first element of the runs being merged.
+    size_t middle;          // The first element of the second run.
+    size_t last;            // One past the last element of the second run.
+    size_t output_begin;    // The elements of the merged output this task writes.
+    size_t output_end;
+} merge_task_t;
+
+typedef struct sort_t {
+    char *data;
+    char *buffer;
+    size_t element_size;
+    vector_compare_func_t compare;
+    size_t *bounds;         // Run i is [bounds[i], bounds[i + 1]).
+    merge_task_t *merges;
+    const char *src;        // The merges read from src and write to dst.
+    char *dst;
+} sort_t;
+
+static void sort_run(void *context, const size_t task) {
+    sort_t *sort = context;
+    const size_t first = sort->bounds[task];
+    qsort(sort->data + first * sort->element_size, sort->bounds[task + 1] - first, sort->element_size,
+          sort->compare);
+}
+
+// The number of elements of run a that come before the diagonal-th element of the merge of runs a
+// and b, where equal elements are taken from a first.
+static size_t merge_path(const sort_t *sort, const char *a, const size_t a_size, const char *b, const size_t b_size,
+                         const size_t diagonal) {
+    const size_t element_size = sort->element_size;
+    size_t low = diagonal > b_size ? diagonal - b_size : 0;
+    size_t high = diagonal < a_size ? diagonal : a_size;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (sort->compare(a + mid * element_size, b + (diagonal - mid - 1) * element_size) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static void sort_merge(void *context, const size_t task) {
+    sort_t *sort = context;
+    const merge_task_t *merge = &sort->merges[task];
+    const size_t element_size = sort->element_size;
+    const char *a = sort->src + merge->first * element_size;
+    const char *b = sort->src + merge->middle * element_size;
+    const size_t a_size = merge->middle - merge->first;
+    const size_t b_size = merge->last - merge->middle;
+
+    const vector_memcpy_func_t memcpy_func = vector_get_global_memcpy_func();
+    assert(memcpy_func);
+
+    const size_t diagonal = merge->output_begin - merge->first;
+    size_t i = merge_path(sort, a, a_size, b, b_size, diagonal);
+    size_t j = diagonal - i;
+    char *out = sort->dst + merge->output_begin * element_size;
+    for (size_t count = merge->output_end - merge->output_begin; count > 0; --count) {
+        if (j >= b_size || (i < a_size && sort->compare(a + i * element_size, b + j * element_size) <= 0)) {
+            memcpy_func(out, a + i++ * element_size, element_size);
+        } else {
+            memcpy_func(out, b + j++ * element_size, element_size);
+        }
+        out += element_size;
+    }
+}
+
+void vector_parallel_sort(vector_pool_t *pool, vector_t *vector, const vector_compare_func_t compare) {
+    VECTOR_CHECK(pool && vector && compare);
+    VECTOR_CHECK(!vector_element_funcs(vector)->move);
+    const size_t size = vector_size(vector);
+    const size_t element_size = vector_element_size(vector);
+    const size_t nthreads = thread_count(vector_pool_thread_count(pool), size);
+
+    sort_t sort = { vector_data(vector), NULL, element_size, compare, NULL, NULL, NULL, NULL };
+    if (nthreads > 1) {
+        sort.buffer = vector_system_realloc(NULL, size * element_size);
+        sort.bounds = vector_system_realloc(NULL, (nthreads + 1) * sizeof(size_t));
+        sort.merges = vector_system_realloc(NULL, 2 * nthreads * sizeof(merge_task_t));
+    }
+    if (!sort.buffer || !sort.bounds || !sort.merges) {
+        vector_system_free(sort.buffer);
+        vector_system_free(sort.bounds);
+        vector_system_free(sort.merges);
+        if (size > 1) {
+            qsort(sort.data, size, element_size, compare);
+        }
+        return;
+    }
+
+    size_t runs = nthreads;
+    for (size_t i = 0; i <= runs; ++i) {
+        sort.bounds[i] = split(size, runs, i);
+    }
+    run_pool_tasks(pool, runs, sort_run, &sort);
+
+    // Merge pairs of runs until one is left, splitting each merge into pieces in proportion to its
+    // size so that there are about nthreads pieces in total.
+    sort.src = sort.data;
+    sort.dst = sort.buffer;
+    while (runs > 1) {
+        size_t count = 0;
+        for (size_t run = 0; run < runs; run += 2) {
+            const size_t first = sort.bounds[run];
+            const size_t middle = sort.bounds[run + 1];
+            const size_t last = run + 2 <= runs ? sort.bounds[run + 2] : middle;
+            const size_t length = last - first;
+            const size_t pieces = (length * nthreads + size - 1) / size;
+            for (size_t piece = 0; piece < pieces; ++piece) {
+                merge_task_t *merge = &sort.merges[count++];
+                merge->first = first;
+                merge->middle = middle;
+                merge->last = last;
+                merge->output_begin = first + length * piece / pieces;
+                merge->output_end = first + length * (piece + 1) / pieces;
+            }
+            sort.bounds[run / 2] = first;
+        }
+        assert(count <= 2 * nthreads);
+        runs = (runs + 1) / 2;
+        sort.bounds[runs] = size;
+        run_pool_tasks(pool, count, sort_merge, &sort);
+
+        char *src = sort.dst;
+        sort.dst = (char *)sort.src;
+        sort.src = src;
+    }
+    if (sort.src != sort.data) {
+        vector_memcpy_func_t memcpy_func = vector_get_global_memcpy_func();
+        assert(memcpy_func);
+        memcpy_func(sort.data, sort.src, size * element_size);
+    }
+
+    vector_system_free(sort.buffer);
+    vector_system_free(sort.bounds);
+    vector_system_free(sort.merges);
+}
+
+// Prefix sums
+
+typedef union scalar_t {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+    float f;
+    double d;
+} scalar_t;
+
+typedef struct scan_kernels_t {
+    scalar_t (*sum)(const void *data, size_t begin, size_t end);
+    scalar_t (*add)(scalar_t first, scalar_t second);
+    void (*scan)(void *data, size_t begin, size_t end, scalar_t offset, bool inclusive);
+} scan_kernels_t;
+
+// Kernels for a type. Integers are summed as unsigned integers of the same width so that overflow
+// wraps around instead of being undefined.
+#define SCAN_KERNELS(name, type, sum_type, field) \
+    static scalar_t name##_sum(const void *data, size_t begin, size_t end) { \
+        const type *values = data; \
+        sum_type sum = 0; \
+        for (size_t i = begin; i < end; ++i) { \
+            sum += (sum_type)values[i]; \
+        } \
+        scalar_t result; \
+        result.field = sum; \
+        return result; \
+    } \
+    static scalar_t name##_add(scalar_t first, scalar_t second) { \
+        first.field = (sum_type)(first.field + second.field); \
+        return first; \
+    } \
+    static void name##_scan(void *data, size_t begin, size_t end, scalar_t offset, bool inclusive) { \
+        type *values = data; \
+        sum_type sum = offset.field; \
+        if (inclusive) { \
+            for (size_t i = begin; i < end; ++i) { \
+                sum += (sum_type)values[i]; \
+                values[i] = (type)sum; \
+            } \
+        } else { \
+            for (size_t i = begin; i < end; ++i) { \
+                const sum_type value = (sum_type)values[i]; \
+                values[i] = (type)sum; \
+                sum += value; \
+            } \
+        } \
+    }
+
+SCAN_KERNELS(int8, int8_t, uint8_t, u8)
+SCAN_KERNELS(uint8, uint8_t, uint8_t, u8)
+SCAN_KERNELS(int16, int16_t, uint16_t, u16)
+SCAN_KERNELS(uint16, uint16_t, uint16_t, u16)
+SCAN_KERNELS(int32, int32_t, uint32_t, u32)
+SCAN_KERNELS(uint32, uint32_t, uint32_t, u32)
+SCAN_KERNELS(int64, int64_t, uint64_t, u64)
+SCAN_KERNELS(uint64, uint64_t, uint64_t, u64)
+SCAN_KERNELS(float, float, float, f)
+SCAN_KERNELS(double, double, double, d)
+
+#define SCAN_KERNELS_ENTRY(name) { name##_sum, name##_add, name##_scan }
+
+// Indexed by vector_scalar_type_t.
+static const scan_kernels_t SCAN_KERNELS_BY_TYPE[] = {
+    SCAN_KERNELS_ENTRY(int8),
+    SCAN_KERNELS_ENTRY(uint8),
+    SCAN_KERNELS_ENTRY(int16),
+    SCAN_KERNELS_ENTRY(uint16),
+    SCAN_KERNELS_ENTRY(int32),
+    SCAN_KERNELS_ENTRY(uint32),
+    SCAN_KERNELS_ENTRY(int64),
+    SCAN_KERNELS_ENTRY(uint64),
+    SCAN_KERNELS_ENTRY(float),
+    SCAN_KERNELS_ENTRY(double),
+};
+
+typedef struct scan_state_t {
+    const scan_kernels_t *kernels;
+    void *data;
+    size_t size;
+    size_t blocks;
+    bool inclusive;
+    scalar_t *sums;         // The sum of each block, then the sum of the blocks before each block.
+} scan_state_t;
+
+static inline size_t block_begin(const scan_state_t *state, const size_t block) {
+    return split(state->size, state->blocks, block);
+}
+
+static void scan_sum_block(void *context, const size_t block) {
+    scan_state_t *state = context;
+    state->sums[block] = state->kernels->sum(state->data, block_begin(state, block), block_begin(state, block + 1));
+}
+
+static void scan_block(void *context, const size_t block) {
+    scan_state_t *state = context;
+    state->kernels->scan(state->data, block_begin(state, block), block_begin(state, block + 1), state->sums[block],
+                         state->inclusive);
+}
+
+void vector_parallel_scan(vector_pool_t *pool, vector_t *vector, const vector_scalar_type_t type,
+                          const vector_scan_t scan) {
+    VECTOR_CHECK(pool && vector && type <= VECTOR_SCALAR_DOUBLE);
+    VECTOR_CHECK(vector_element_size(vector) == vector_scalar_type_size(type));
+    VECTOR_CHECK(scan == VECTOR_SCAN_INCLUSIVE || scan == VECTOR_SCAN_EXCLUSIVE);
+
+    scan_state_t state;
+    state.kernels = &SCAN_KERNELS_BY_TYPE[type];
+    state.data = vector_data(vector);
+    state.size = vector_size(vector);
+    state.blocks = thread_count(vector_pool_thread_count(pool), state.size);
+    state.inclusive = scan == VECTOR_SCAN_INCLUSIVE;
+    state.sums = state.blocks > 1 ? vector_system_realloc(NULL, state.blocks * sizeof(scalar_t)) : NULL;
+
+    const scalar_t zero = state.kernels->sum(state.data, 0, 0);
+    if (!state.sums) {
+        state.kernels->scan(state.data, 0, state.size, zero, state.inclusive);
+        return;
+    }
+
+    // Sum each block, turn the block sums into the offset of each block, then scan each block.
+    run_pool_tasks(pool, state.blocks, scan_sum_block, &state);
+    scalar_t offset = zero;
+    for (size_t block = 0; block < state.blocks; ++block) {
+        const scalar_t sum = state.sums[block];
+        state.sums[block] = offset;
+        offset = state.kernels->add(offset, sum);
+    }
+    run_pool_tasks(pool, state.blocks, scan_block, &state);
+
+    vector_system_free(state.sums);
+}
+
+// Per-thread accumulators
+
+// Storage for count accumulators of size bytes each, each starting on its own cache line.
+typedef struct accumulators_t {
+    void *allocation;
+    char *first;
+    size_t stride;
+} accumulators_t;
+
+static bool accumulators_create(accumulators_t *accumulators, const size_t count, const size_t size) {
+    accumulators->stride = (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    accumulators->allocation = NULL;
+    if (accumulators->stride < size || accumulators->stride > (SIZE_MAX - CACHE_LINE_SIZE) / count) {
+        return false;
+    }
+    accumulators->allocation = vector_system_realloc(NULL, count * accumulators->stride + CACHE_LINE_SIZE);
+    const uintptr_t address = (uintptr_t)accumulators->allocation;
+    accumulators->first = (char *)accumulators->allocation + (CACHE_LINE_SIZE - address % CACHE_LINE_SIZE) % CACHE_LINE_SIZE;
+    return accumulators->allocation != NULL;
+}
+
+static inline void *accumulator(const accumulators_t *accumulators, const size_t index) {
+    return accumulators->first + index * accumulators->stride;
+}
+
+// Reductions
+
+typedef struct reduce_t {
+    const char *data;
+    size_t size;
+    size_t element_size;
+    size_t blocks;
+    const void *identity;
+    vector_combine_func_t combine;
+    vector_memcpy_func_t memcpy_func;
+    accumulators_t accumulators;
+} reduce_t;
+
+static void reduce_block(void *context, const size_t block) {
+    reduce_t *reduce = context;
+    void *sum = accumulator(&reduce->accumulators, block);
+    reduce->memcpy_func(sum, reduce->identity, reduce->element_size);
+    const char *element = reduce->data + split(reduce->size, reduce->blocks, block) * reduce->element_size;
+    const char *end = reduce->data + split(reduce->size, reduce->blocks, block + 1) * reduce->element_size;
+    for (; element != end; element += reduce->element_size) {
+        reduce->combine(sum, element);
+    }
+}
+
+void vector_parallel_reduce(vector_pool_t *pool, const vector_t *vector, const void *identity,
+                            const vector_combine_func_t combine, void *result) {
+    VECTOR_CHECK(pool && vector && identity && combine && result);
+    VECTOR_CHECK(!vector_element_funcs(vector)->move);
+
+    reduce_t reduce;
+    reduce.data = vector_data(vector);
+    reduce.size = vector_size(vector);
+    reduce.element_size = vector_element_size(vector);
+    reduce.blocks = thread_count(vector_pool_thread_count(pool), reduce.size);
+    reduce.identity = identity;
+    reduce.combine = combine;
+    reduce.memcpy_func = vector_get_global_memcpy_func();
+    assert(reduce.memcpy_func);
+
+    // Without room for the accumulators, combine every element into the result on this thread.
+    reduce.memcpy_func(result, identity, reduce.element_size);
+    if (reduce.blocks == 1 || !accumulators_create(&reduce.accumulators, reduce.blocks, reduce.element_size)) {
+        for (size_t i = 0; i < reduce.size; ++i) {
+            combine(result, reduce.data + i * reduce.element_size);
+        }
+        return;
+    }
+
+    run_pool_tasks(pool, reduce.blocks, reduce_block, &reduce);
+    for (size_t block = 0; block < reduce.blocks; ++block) {
+        combine(result, accumulator(&reduce.accumulators, block));
+    }
+    vector_system_free(reduce.accumulators.allocation);
+}
+
+// Histograms
+
+typedef struct histogram_t {
+    const char *keys;       // The key of the first element.
+    size_t size;
+    size_t element_size;
+    size_t key_width;
+    size_t blocks;
+    size_t *buckets;
+    size_t bucket_count;
+    accumulators_t counts;
+} histogram_t;
+
+#define COUNT_KEYS(type) { \
+        for (const char *key = begin; key != end; key += element_size) { \
+            type value; \
+            memcpy(&value, key, sizeof(type)); \
+            if (value < bucket_count) { \
+                ++counts[value]; \
+            } \
+        } \
+    }
+
+// Count the keys of the elements from begin to end.
+static void count_keys(const char *begin, const char *end, const size_t element_size, const size_t key_width,
+                       size_t *counts, const size_t bucket_count) {
+    switch (key_width) {
+        case 1: COUNT_KEYS(uint8_t) break;
+        case 2: COUNT_KEYS(uint16_t) break;
+        case 4: COUNT_KEYS(uint32_t) break;
+        default: COUNT_KEYS(uint64_t) break;
+    }
+}
+
+static void histogram_count(void *context, const size_t block) {
+    histogram_t *histogram = context;
+    size_t *counts = accumulator(&histogram->counts, block);
+    memset(counts, 0, histogram->bucket_count * sizeof(size_t));
+    count_keys(histogram->keys + split(histogram->size, histogram->blocks, block) * histogram->element_size,
+               histogram->keys + split(histogram->size, histogram->blocks, block + 1) * histogram->element_size,
+               histogram->element_size, histogram->key_width, counts, histogram->bucket_count);
+}
+
+// Add every thread's counts for one block of the buckets.
+static void histogram_merge(void *context, const size_t block) {
+    histogram_t *histogram = context;
+    const size_t begin = split(histogram->bucket_count, histogram->blocks, block);
+    const size_t end = split(histogram->bucket_count, histogram->blocks, block + 1);
+    for (size_t thread = 0; thread < histogram->blocks; ++thread) {
+        const size_t *counts = accumulator(&histogram->counts, thread);
+        for (size_t bucket = begin; bucket < end; ++bucket) {
+            histogram->buckets[bucket] += counts[bucket];
+        }
+    }
+}
+
+void vector_histogram(vector_pool_t *pool, const vector_t *vector, const size_t key_offset, const size_t key_width,
+                      vector_t *buckets) {
+    VECTOR_CHECK(pool && vector && buckets);
+    VECTOR_CHECK(key_width == 1 || key_width == 2 || key_width == 4 || key_width == 8);
+    VECTOR_CHECK(key_offset + key_width <= vector_element_size(vector));
+    VECTOR_CHECK(vector_element_size(buckets) == sizeof(size_t));
+
+    histogram_t histogram;
+    histogram.keys = (const char *)vector_data(vector) + key_offset;
+    histogram.size = vector_size(vector);
+    histogram.element_size = vector_element_size(vector);
+    histogram.key_width = key_width;
+    histogram.blocks = thread_count(vector_pool_thread_count(pool), histogram.size);
+    histogram.buckets = vector_data(buckets);
+    histogram.bucket_count = vector_size(buckets);
+    if (histogram.size == 0 || histogram.bucket_count == 0) {
+        return;
+    }
+
+    // Each thread clears and merges a full set of counts, so with many buckets fewer threads are
+    // used, and without room for the private counts this thread counts straight into the buckets.
+    const size_t useful = histogram.size / histogram.bucket_count;
+    histogram.blocks = useful < histogram.blocks ? (useful > 0 ? useful : 1) : histogram.blocks;
+    if (histogram.blocks == 1 ||
+        !accumulators_create(&histogram.counts, histogram.blocks, histogram.bucket_count * sizeof(size_t))) {
+        count_keys(histogram.keys, histogram.keys + histogram.size * histogram.element_size, histogram.element_size,
+                   key_width, histogram.buckets, histogram.bucket_count);
+        return;
+    }
+
+    run_pool_tasks(pool, histogram.blocks, histogram_count, &histogram);
+    run_pool_tasks(pool, histogram.blocks, histogram_merge, &histogram);
+    vector_system_free(histogram.counts.allocation);
+}
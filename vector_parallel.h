@@ -0,0 +1,120 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_PARALLEL_H
+#define VECTOR_PARALLEL_H
+
+/**
+ @file vector_parallel.h
+
+ Multi-threaded algorithms over the elements of a vector (optional, requires POSIX threads).
+
+ Each function takes a @c vector_pool_t (see vector_pool.h), splits its work across the pool's
+ threads, including the calling thread, and returns when all of the work is done. The pool's
+ threads are started once and reused, so no threads are started per call. Small vectors are
+ processed by fewer threads, or on the calling thread alone, since dividing them further would cost
+ more than it saves. Temporary memory is allocated with the library's realloc() function.
+
+ The algorithms move elements bytewise, like qsort(), so they cannot be used with vectors that have
+ a move function (see vector_set_element_funcs()).
+ */
+
+#include "vector.h"
+#include "vector_pool.h"
+#include "vector_search.h"
+
+/** A function that compares two elements like qsort()'s comparison function. */
+typedef int (*vector_compare_func_t)(const void *first, const void *second);
+
+/**
+ A function that combines a value into an accumulator of the same type, e.g. by adding it.
+
+ The combination must be associative, but need not be commutative.
+ */
+typedef void (*vector_combine_func_t)(void *accumulator, const void *value);
+
+/** Whether a prefix sum includes the element at each position. */
+typedef enum vector_scan_t {
+    VECTOR_SCAN_INCLUSIVE,      /**< Element i becomes the sum of elements 0 to i. */
+    VECTOR_SCAN_EXCLUSIVE,      /**< Element i becomes the sum of elements 0 to i - 1, and element 0 becomes 0. */
+} vector_scan_t;
+
+/**
+ Sort a vector's elements in place using a thread pool's threads.
+
+ Each thread sorts a contiguous run of the elements with qsort(), then the runs are merged
+ pairwise, with every merge split between the threads along its merge path so that all threads stay
+ busy until the end. Like qsort(), the sort is not stable. The merges need a temporary buffer as
+ large as the vector's elements; if it cannot be allocated, the vector is sorted on the calling
+ thread with qsort().
+
+ @param pool    The thread pool to run on.
+ @param vector  A vector without a move function.
+ @param compare A function comparing two elements.
+ */
+VECTOR_EXTERN void vector_parallel_sort(vector_pool_t *pool, vector_t *vector, const vector_compare_func_t compare);
+
+/**
+ Replace a vector of scalars with its prefix sums in place using a thread pool's threads.
+
+ Integer sums wrap around on overflow like unsigned arithmetic. Floating-point sums are computed in
+ a different order than a sequential loop would use, so may differ from it in the last bits.
+
+ @param pool   The thread pool to run on.
+ @param vector A vector whose element size is @c vector_scalar_type_size(type).
+ @param type   The type of the vector's elements.
+ @param scan   Whether the sums are inclusive or exclusive.
+ */
+VECTOR_EXTERN void vector_parallel_scan(vector_pool_t *pool, vector_t *vector, const vector_scalar_type_t type,
+                                        const vector_scan_t scan);
+
+/**
+ Combine all of a vector's elements into one value using a thread pool's threads.
+
+ Each thread combines a contiguous block of the elements into its own accumulator, which starts as
+ a copy of @c identity. The accumulators are kept on separate cache lines so that the threads do
+ not slow each other down. At the end the accumulators are combined in block order into @c result,
+ so the result is the same as combining the elements in order into @c identity.
+
+ @param pool     The thread pool to run on.
+ @param vector   A vector without a move function.
+ @param identity A pointer to an element that leaves any value unchanged when combined into it,
+                 such as zero for addition.
+ @param combine  A function that combines a value into an accumulator.
+ @param result   A pointer to storage for the combined value of @c vector_element_size(vector)
+                 bytes. It may not overlap the vector's elements.
+ */
+VECTOR_EXTERN void vector_parallel_reduce(vector_pool_t *pool, const vector_t *vector, const void *identity,
+                                          const vector_combine_func_t combine, void *result);
+
+/**
+ Count how many elements of a vector have each key using a thread pool's threads.
+
+ Each element's key is the unsigned integer of @c key_width bytes at byte @c key_offset within the
+ element, in the machine's byte order. Each thread counts its block of elements into its own
+ private counts, padded onto separate cache lines, and the private counts are then added to
+ @c buckets. Elements whose key is not less than the number of buckets are not counted.
+
+ @param pool       The thread pool to run on.
+ @param vector     A vector.
+ @param key_offset The offset of each element's key in bytes.
+ @param key_width  The size of each element's key in bytes: 1, 2, 4 or 8.
+ @param buckets    A vector of @c size_t counts, one per key, that the counts are added to.
+ */
+VECTOR_EXTERN void vector_histogram(vector_pool_t *pool, const vector_t *vector, const size_t key_offset,
+                                    const size_t key_width, vector_t *buckets);
+
+#endif
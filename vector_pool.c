@@ -0,0 +1,287 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector_pool.h"
+#include "vector_atomic.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+// Threads' ranges are padded apart so that one thread taking a chunk does not invalidate the cache
+// line holding another thread's range.
+#define CACHE_LINE_SIZE 64
+
+// With the default grain, each thread's initial range is split into this many chunks.
+static const size_t DEFAULT_CHUNKS_PER_THREAD = 16;
+
+// The remaining range of indices of one thread. Thread 0 is the thread calling
+// vector_parallel_for(); the others are the pool's helper threads.
+typedef struct worker_t {
+    pthread_mutex_t lock;
+    size_t begin;
+    size_t end;
+    pthread_t thread;
+    struct vector_pool_t *pool;
+    char padding[CACHE_LINE_SIZE];
+} worker_t;
+
+struct vector_pool_t {
+    worker_t *workers;
+    size_t nthreads;
+
+    // Wakes the helper threads for a new loop or to stop, and tells the caller when they are done.
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    size_t generation;
+    size_t active;
+    bool stopping;
+
+    // The current job: either a function to run once per thread, or a loop over ranges of a vector
+    // in which pending counts the elements not yet processed.
+    vector_thread_func_t thread_func;
+    vector_range_func_t func;
+    void *context;
+    vector_t *vector;
+    size_t grain;
+    size_t pending;
+};
+
+// Take a chunk of at most grain elements from the front of a worker's own range.
+static bool take(worker_t *worker, const size_t grain, size_t *begin, size_t *end) {
+    pthread_mutex_lock(&worker->lock);
+    const bool found = worker->begin < worker->end;
+    if (found) {
+        *begin = worker->begin;
+        *end = worker->end - worker->begin > grain ? worker->begin + grain : worker->end;
+        worker->begin = *end;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return found;
+}
+
+// Move the back half of another worker's range, rounded up, into a worker's empty range.
+static bool steal(vector_pool_t *pool, worker_t *thief) {
+    const size_t index = (size_t)(thief - pool->workers);
+    for (size_t i = 1; i < pool->nthreads; ++i) {
+        worker_t *victim = &pool->workers[(index + i) % pool->nthreads];
+        pthread_mutex_lock(&victim->lock);
+        const size_t begin = victim->begin + (victim->end - victim->begin) / 2;
+        const size_t end = victim->end;
+        victim->end = begin;
+        pthread_mutex_unlock(&victim->lock);
+
+        if (begin < end) {
+            pthread_mutex_lock(&thief->lock);
+            thief->begin = begin;
+            thief->end = end;
+            pthread_mutex_unlock(&thief->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Process chunks until every element of the current loop has been processed. A worker with nothing
+// to take or steal keeps looking, since a range may be in transit between two other workers.
+static void work(vector_pool_t *pool, worker_t *worker) {
+    while (VECTOR_ATOMIC_LOAD_ACQUIRE(&pool->pending) > 0) {
+        size_t begin, end;
+        if (take(worker, pool->grain, &begin, &end) || (steal(pool, worker) && take(worker, pool->grain, &begin, &end))) {
+            pool->func(pool->context, pool->vector, begin, end);
+            VECTOR_ATOMIC_FETCH_SUB(&pool->pending, end - begin);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+// Run the current job on one thread.
+static void run_job(vector_pool_t *pool, worker_t *worker) {
+    if (pool->thread_func) {
+        pool->thread_func(pool->context, (size_t)(worker - pool->workers), pool->nthreads);
+    } else {
+        work(pool, worker);
+    }
+}
+
+// Start the current job on the helper threads, run it on the calling thread, then wait for the
+// helpers to finish.
+static void run_on_all_threads(vector_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->active = pool->nthreads - 1;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_job(pool, &pool->workers[0]);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void *helper_thread(void *arg) {
+    worker_t *worker = arg;
+    vector_pool_t *pool = worker->pool;
+    size_t generation = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->generation == generation) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_job(pool, worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void stop_helpers(vector_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->nthreads; ++i) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+}
+
+vector_pool_t *vector_pool_create(size_t nthreads) {
+    if (nthreads == 0) {
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = processors > 0 ? (size_t)processors : 1;
+    }
+
+    vector_pool_t *pool = vector_system_realloc(NULL, sizeof(vector_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->workers = vector_system_realloc(NULL, nthreads * sizeof(worker_t));
+    if (!pool->workers) {
+        vector_system_free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->active = 0;
+    pool->stopping = false;
+    pool->thread_func = NULL;
+    pool->func = NULL;
+    pool->context = NULL;
+    pool->vector = NULL;
+    pool->grain = 1;
+    pool->pending = 0;
+
+    // Start the helper threads, keeping however many could be started.
+    pool->nthreads = 1;
+    for (size_t i = 0; i < nthreads; ++i) {
+        worker_t *worker = &pool->workers[i];
+        pthread_mutex_init(&worker->lock, NULL);
+        worker->begin = 0;
+        worker->end = 0;
+        worker->pool = pool;
+        if (i > 0) {
+            if (pthread_create(&worker->thread, NULL, helper_thread, worker) != 0) {
+                pthread_mutex_destroy(&worker->lock);
+                break;
+            }
+            ++pool->nthreads;
+        }
+    }
+    return pool;
+}
+
+void vector_pool_destroy(vector_pool_t *pool) {
+    VECTOR_CHECK(pool);
+    stop_helpers(pool);
+    for (size_t i = 0; i < pool->nthreads; ++i) {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    vector_system_free(pool->workers);
+    vector_system_free(pool);
+}
+
+size_t vector_pool_thread_count(const vector_pool_t *pool) {
+    VECTOR_CHECK(pool);
+    return pool->nthreads;
+}
+
+void vector_pool_run(vector_pool_t *pool, const vector_thread_func_t func, void *context) {
+    VECTOR_CHECK(pool && func);
+    pool->thread_func = func;
+    pool->context = context;
+    run_on_all_threads(pool);
+}
+
+void vector_parallel_for(vector_pool_t *pool, vector_t *vector, size_t grain, const vector_range_func_t func,
+                         void *context) {
+    VECTOR_CHECK(pool && vector && func);
+    const size_t size = vector_size(vector);
+    const size_t nthreads = pool->nthreads;
+    if (grain == 0) {
+        grain = size / (nthreads * DEFAULT_CHUNKS_PER_THREAD);
+        grain = grain > 0 ? grain : 1;
+    }
+
+    // Loops that fit in one chunk, or pools without helpers, run on the calling thread.
+    if (nthreads == 1 || size <= grain) {
+        for (size_t begin = 0; begin < size; begin += grain) {
+            func(context, vector, begin, size - begin > grain ? begin + grain : size);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < nthreads; ++i) {
+        worker_t *worker = &pool->workers[i];
+        pthread_mutex_lock(&worker->lock);
+        worker->begin = size / nthreads * i + (i < size % nthreads ? i : size % nthreads);
+        worker->end = size / nthreads * (i + 1) + (i + 1 < size % nthreads ? i + 1 : size % nthreads);
+        pthread_mutex_unlock(&worker->lock);
+    }
+
+    pool->thread_func = NULL;
+    pool->func = func;
+    pool->context = context;
+    pool->vector = vector;
+    pool->grain = grain;
+    VECTOR_ATOMIC_STORE_RELEASE(&pool->pending, size);
+    run_on_all_threads(pool);
+}
@@ -0,0 +1,125 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_POOL_H
+#define VECTOR_POOL_H
+
+/**
+ @file vector_pool.h
+
+ A pool of threads that process ranges of a vector's elements with work stealing (optional,
+ requires POSIX threads).
+
+ @c vector_parallel_for() splits a vector's indices evenly between the pool's threads. Each thread
+ processes its own range in chunks of @c grain elements from the front, and a thread that runs out
+ steals the back half of another thread's remaining range. When the cost per element varies, the
+ threads that finish early take over the work of the ones that fall behind, instead of waiting for
+ them as they would with a fixed split.
+
+ The threads are started once by @c vector_pool_create() and sleep between calls, so a pool can be
+ reused for many loops cheaply. The algorithms in vector_parallel.h run on a pool too.
+ */
+
+#include "vector.h"
+
+/** An anonymous structure for storing a thread pool's state. */
+struct vector_pool_t;
+
+/** A set of threads that run parallel loops. */
+typedef struct vector_pool_t vector_pool_t;
+
+/**
+ A function that processes the elements of a vector with indices in [@c begin, @c end).
+
+ @param context The context passed to @c vector_parallel_for().
+ @param vector  The vector passed to @c vector_parallel_for().
+ @param begin   The index of the first element to process.
+ @param end     One past the index of the last element to process.
+ */
+typedef void (*vector_range_func_t)(void *context, vector_t *vector, size_t begin, size_t end);
+
+/**
+ A function run once on each of a thread pool's threads.
+
+ @param context  The context passed to @c vector_pool_run().
+ @param thread   The index of the calling thread in the pool, from zero to @c nthreads - 1. Thread
+                 zero is the thread that called @c vector_pool_run().
+ @param nthreads The number of threads in the pool.
+ */
+typedef void (*vector_thread_func_t)(void *context, size_t thread, size_t nthreads);
+
+/**
+ Create a thread pool.
+
+ @param nthreads The number of threads that run loops, including the thread that calls
+                 @c vector_parallel_for(), or zero for one per online processor.
+
+ @return A new thread pool, or @c NULL if memory could not be allocated.
+ */
+VECTOR_EXTERN vector_pool_t *vector_pool_create(size_t nthreads);
+
+/**
+ Stop a thread pool's threads and deallocate its memory.
+
+ @param pool A thread pool that is not running a loop.
+ */
+VECTOR_EXTERN void vector_pool_destroy(vector_pool_t *pool);
+
+/**
+ Return the number of threads that run a thread pool's loops.
+
+ This may be less than requested if threads could not be started.
+
+ @param pool A thread pool.
+
+ @return The number of threads, including the thread that calls @c vector_parallel_for().
+ */
+VECTOR_EXTERN size_t vector_pool_thread_count(const vector_pool_t *pool);
+
+/**
+ Call a function once on each of a thread pool's threads, and return when all calls have returned.
+
+ Useful for setting up per-thread state, such as an allocation policy. Each thread's index is also
+ the index of the range of elements it starts with in @c vector_parallel_for(): thread @c i starts
+ with about the @c i-th of @c nthreads equal parts of the vector.
+
+ @param pool    A thread pool.
+ @param func    The function to call on each thread.
+ @param context An argument passed to each call of @c func.
+ */
+VECTOR_EXTERN void vector_pool_run(vector_pool_t *pool, const vector_thread_func_t func, void *context);
+
+/**
+ Call a function on ranges of a vector's indices that together cover [0, @c vector_size(vector))
+ once each, using a thread pool's threads.
+
+ The calling thread takes part in the loop and returns when every range has been processed. The
+ function is called with ranges of at most @c grain elements, concurrently from several threads.
+ It must not change the vector's size or storage, and must not start another loop on the same
+ pool. Only one thread at a time may run a loop on a pool.
+
+ @param pool    A thread pool.
+ @param vector  A vector.
+ @param grain   The maximum number of elements per call, or zero to choose one from the vector's
+                size and the number of threads. Smaller grains balance irregular work better, at
+                the cost of more calls.
+ @param func    The function to call for each range.
+ @param context An argument passed to each call of @c func.
+ */
+VECTOR_EXTERN void vector_parallel_for(vector_pool_t *pool, vector_t *vector, size_t grain,
+                                       const vector_range_func_t func, void *context);
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector_rcu.h"
+#include "vector_atomic.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+
+// Readers are padded apart so that one reader setting its hazard pointer does not invalidate the
+// cache line holding another's.
+#define CACHE_LINE_SIZE 64
+
+struct vector_rcu_reader_t {
+    const vector_t *hazard;                 // The version the reader holds, or NULL.
+    struct vector_rcu_t *rcu;
+    struct vector_rcu_reader_t *next;
+    char padding[CACHE_LINE_SIZE];
+};
+
+struct vector_rcu_t {
+    size_t element_size;
+    const vector_t *front;                  // The published version.
+    pthread_mutex_t lock;                   // Serializes writers and guards the fields below.
+    vector_rcu_reader_t *readers;
+    vector_t *retired;                      // Replaced versions that readers may still hold.
+    vector_t *spare;                        // A reclaimed version for vector_rcu_back(), or NULL.
+};
+
+// Whether any reader holds a version. A reader publishes its hazard pointer and then re-reads the
+// front, while a writer replaces the front and then reads the hazard pointers, each with a full
+// fence in between, so either the writer sees the hazard or the reader sees the new front.
+static bool held(const vector_rcu_t *rcu, const vector_t *version) {
+    for (const vector_rcu_reader_t *reader = rcu->readers; reader; reader = reader->next) {
+        if (VECTOR_ATOMIC_LOAD_ACQUIRE(&reader->hazard) == version) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Destroy or keep as the spare each retired version that no reader holds. Called with the lock held.
+static size_t reclaim(vector_rcu_t *rcu) {
+    VECTOR_ATOMIC_FENCE_SEQ_CST();
+    vector_t **versions = vector_data(rcu->retired);
+    size_t count = vector_size(rcu->retired);
+    for (size_t i = 0; i < count;) {
+        if (held(rcu, versions[i])) {
+            ++i;
+            continue;
+        }
+        if (rcu->spare) {
+            vector_destroy(versions[i]);
+        } else {
+            rcu->spare = versions[i];
+        }
+        versions[i] = versions[--count];
+    }
+    vector_resize(rcu->retired, count);
+    return count;
+}
+
+vector_rcu_t *vector_rcu_create(const size_t element_size) {
+    VECTOR_CHECK(element_size > 0);
+    vector_rcu_t *rcu = vector_system_realloc(NULL, sizeof(vector_rcu_t));
+    if (!rcu) {
+        return NULL;
+    }
+    vector_t *front = vector_create(element_size);
+    rcu->retired = vector_create(sizeof(vector_t *));
+    if (!front || !rcu->retired) {
+        if (front) {
+            vector_destroy(front);
+        }
+        if (rcu->retired) {
+            vector_destroy(rcu->retired);
+        }
+        vector_system_free(rcu);
+        return NULL;
+    }
+    rcu->element_size = element_size;
+    rcu->front = front;
+    pthread_mutex_init(&rcu->lock, NULL);
+    rcu->readers = NULL;
+    rcu->spare = NULL;
+    return rcu;
+}
+
+void vector_rcu_destroy(vector_rcu_t *rcu) {
+    VECTOR_CHECK(rcu);
+    for (vector_rcu_reader_t *reader = rcu->readers; reader;) {
+        vector_rcu_reader_t *next = reader->next;
+        vector_system_free(reader);
+        reader = next;
+    }
+    vector_t **versions = vector_data(rcu->retired);
+    for (size_t i = 0; i < vector_size(rcu->retired); ++i) {
+        vector_destroy(versions[i]);
+    }
+    vector_destroy(rcu->retired);
+    if (rcu->spare) {
+        vector_destroy(rcu->spare);
+    }
+    vector_destroy((vector_t *)rcu->front);
+    pthread_mutex_destroy(&rcu->lock);
+    vector_system_free(rcu);
+}
+
+vector_rcu_reader_t *vector_rcu_reader_create(vector_rcu_t *rcu) {
+    VECTOR_CHECK(rcu);
+    vector_rcu_reader_t *reader = vector_system_realloc(NULL, sizeof(vector_rcu_reader_t));
+    if (reader) {
+        reader->hazard = NULL;
+        reader->rcu = rcu;
+        pthread_mutex_lock(&rcu->lock);
+        reader->next = rcu->readers;
+        rcu->readers = reader;
+        pthread_mutex_unlock(&rcu->lock);
+    }
+    return reader;
+}
+
+void vector_rcu_reader_destroy(vector_rcu_reader_t *reader) {
+    VECTOR_CHECK(reader && !reader->hazard);
+    vector_rcu_t *rcu = reader->rcu;
+    pthread_mutex_lock(&rcu->lock);
+    vector_rcu_reader_t **link = &rcu->readers;
+    while (*link != reader) {
+        link = &(*link)->next;
+    }
+    *link = reader->next;
+    pthread_mutex_unlock(&rcu->lock);
+    vector_system_free(reader);
+}
+
+const vector_t *vector_rcu_read_lock(vector_rcu_reader_t *reader) {
+    VECTOR_CHECK(reader && !reader->hazard);
+    const vector_t *version = VECTOR_ATOMIC_LOAD_ACQUIRE(&reader->rcu->front);
+    for (;;) {
+        VECTOR_ATOMIC_STORE_RELAXED(&reader->hazard, version);
+        VECTOR_ATOMIC_FENCE_SEQ_CST();
+        const vector_t *front = VECTOR_ATOMIC_LOAD_ACQUIRE(&reader->rcu->front);
+        if (front == version) {
+            return version;
+        }
+        version = front;
+    }
+}
+
+void vector_rcu_read_unlock(vector_rcu_reader_t *reader) {
+    VECTOR_CHECK(reader && reader->hazard);
+    VECTOR_ATOMIC_STORE_RELEASE(&reader->hazard, NULL);
+}
+
+vector_t *vector_rcu_back(vector_rcu_t *rcu) {
+    VECTOR_CHECK(rcu);
+    pthread_mutex_lock(&rcu->lock);
+    if (!rcu->spare) {
+        reclaim(rcu);
+    }
+    vector_t *back = rcu->spare;
+    rcu->spare = NULL;
+    pthread_mutex_unlock(&rcu->lock);
+
+    if (back) {
+        vector_clear(back);
+        return back;
+    }
+    return vector_create(rcu->element_size);
+}
+
+void vector_rcu_publish(vector_rcu_t *rcu, vector_t *vector) {
+    VECTOR_CHECK(rcu && vector && vector_element_size(vector) == rcu->element_size);
+    pthread_mutex_lock(&rcu->lock);
+    vector_t *previous = (vector_t *)rcu->front;
+    VECTOR_ATOMIC_STORE_RELEASE(&rcu->front, vector);
+    const size_t retired = vector_size(rcu->retired);
+    vector_push_back(rcu->retired, &previous);
+    if (vector_size(rcu->retired) == retired) {
+        // Without room to retire the previous version, wait for its readers to finish with it.
+        VECTOR_ATOMIC_FENCE_SEQ_CST();
+        while (held(rcu, previous)) {
+            sched_yield();
+        }
+        vector_destroy(previous);
+    }
+    reclaim(rcu);
+    pthread_mutex_unlock(&rcu->lock);
+}
+
+size_t vector_rcu_reclaim(vector_rcu_t *rcu) {
+    VECTOR_CHECK(rcu);
+    pthread_mutex_lock(&rcu->lock);
+    const size_t count = reclaim(rcu);
+    pthread_mutex_unlock(&rcu->lock);
+    return count;
+}
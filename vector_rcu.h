@@ -0,0 +1,148 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_RCU_H
+#define VECTOR_RCU_H
+
+/**
+ @file vector_rcu.h
+
+ A vector that is read without locks and replaced as a whole (optional, requires POSIX threads).
+
+ A @c vector_rcu_t holds a published version of a vector that readers use without taking a lock.
+ Writers build a new version in a separate vector and publish it, which replaces the published
+ version with one atomic store (read-copy-update). Readers that are still using the previous
+ version keep using it; it is destroyed, or reused for a later version, once no reader holds it.
+
+ Each reader thread registers a @c vector_rcu_reader_t, which holds a hazard pointer: the version
+ that the reader is using, if any. Taking a version costs the reader two loads, a store and a
+ memory fence, and never waits for writers or other readers.
+
+ @code
+ const vector_t *routes = vector_rcu_read_lock(reader);
+ ... read routes ...
+ vector_rcu_read_unlock(reader);
+ @endcode
+
+ This suits data that is read far more often than it is replaced, such as lookup tables rebuilt
+ periodically.
+ */
+
+#include "vector.h"
+
+/** An anonymous structure for storing a read-copy-update vector's state. */
+struct vector_rcu_t;
+
+/** A vector that readers use without locks while writers replace it. */
+typedef struct vector_rcu_t vector_rcu_t;
+
+/** An anonymous structure for storing a reader's state. */
+struct vector_rcu_reader_t;
+
+/** One thread's handle for reading a @c vector_rcu_t. */
+typedef struct vector_rcu_reader_t vector_rcu_reader_t;
+
+/**
+ Create a read-copy-update vector whose published version is empty.
+
+ @param element_size The size of an element in bytes.
+
+ @return A new read-copy-update vector, or @c NULL if memory could not be allocated.
+ */
+VECTOR_EXTERN vector_rcu_t *vector_rcu_create(const size_t element_size);
+
+/**
+ Destroy a read-copy-update vector, its readers and all of its versions.
+
+ @param rcu A read-copy-update vector that no thread is using.
+ */
+VECTOR_EXTERN void vector_rcu_destroy(vector_rcu_t *rcu);
+
+/**
+ Register a reader.
+
+ A reader must only be used by one thread at a time, usually the thread that created it.
+
+ @param rcu A read-copy-update vector.
+
+ @return A new reader, or @c NULL if memory could not be allocated.
+ */
+VECTOR_EXTERN vector_rcu_reader_t *vector_rcu_reader_create(vector_rcu_t *rcu);
+
+/**
+ Unregister a reader and deallocate its memory.
+
+ @param reader A reader that is not holding a version.
+ */
+VECTOR_EXTERN void vector_rcu_reader_destroy(vector_rcu_reader_t *reader);
+
+/**
+ Take the published version for reading.
+
+ The version stays valid, and unchanged, until @c vector_rcu_read_unlock(), even if a writer
+ publishes a new version in the meantime. A reader holds at most one version at a time.
+
+ @param reader A reader that is not holding a version.
+
+ @return The published version, which must not be modified.
+ */
+VECTOR_EXTERN const vector_t *vector_rcu_read_lock(vector_rcu_reader_t *reader);
+
+/**
+ Release the version taken by @c vector_rcu_read_lock().
+
+ @param reader A reader holding a version.
+ */
+VECTOR_EXTERN void vector_rcu_read_unlock(vector_rcu_reader_t *reader);
+
+/**
+ Return an empty vector to build the next version in.
+
+ When a previously published version is no longer held by any reader, its storage is cleared and
+ reused, so a writer that publishes repeatedly alternates between two buffers without allocating.
+
+ @param rcu A read-copy-update vector.
+
+ @return A new empty vector with the element size of @c rcu, or @c NULL if memory could not be
+         allocated. It belongs to the caller until it is published or destroyed.
+ */
+VECTOR_EXTERN vector_t *vector_rcu_back(vector_rcu_t *rcu);
+
+/**
+ Publish a vector as the new version.
+
+ The previously published version is retired and destroyed or reused once no reader holds it.
+ Writers may publish from several threads; publications are serialized.
+
+ @param rcu    A read-copy-update vector.
+ @param vector A vector with the element size of @c rcu, which now belongs to @c rcu. It must not
+               be modified after it is published.
+ */
+VECTOR_EXTERN void vector_rcu_publish(vector_rcu_t *rcu, vector_t *vector);
+
+/**
+ Destroy retired versions that no reader holds.
+
+ This happens on every publication, so it is only needed to free memory sooner, e.g. after readers
+ that held old versions have finished.
+
+ @param rcu A read-copy-update vector.
+
+ @return The number of retired versions that are still held by readers.
+ */
+VECTOR_EXTERN size_t vector_rcu_reclaim(vector_rcu_t *rcu);
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_search.h"
+#include "vector_check.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#   define VECTOR_SEARCH_X86 1
+#   include <immintrin.h>
+#else
+#   define VECTOR_SEARCH_X86 0
+#endif
+
+// Instruction set levels, in increasing order of preference.
+typedef enum isa_t {
+    ISA_SCALAR,
+    ISA_SSE2,
+    ISA_AVX2,
+    ISA_AVX512,
+    ISA_COUNT,
+} isa_t;
+
+// Scan count elements of width bytes for value. Returns the index of the first match (or count) if
+// first_only is set, otherwise the number of matches.
+typedef size_t (*match_kernel_t)(const char *data, size_t count, size_t width, const char *value, bool first_only);
+
+// Store the minimum or maximum of count > 0 scalars in *result.
+typedef void (*extreme_kernel_t)(const void *data, size_t count, bool max, void *result);
+
+static isa_t best_isa(void) {
+#if VECTOR_SEARCH_X86
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return ISA_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return ISA_SSE2;
+    }
+#endif
+    return ISA_SCALAR;
+}
+
+static size_t match_scalar(const char *data, size_t count, size_t width, const char *value, bool first_only) {
+    size_t matches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (memcmp(data + i * width, value, width) == 0) {
+            if (first_only) {
+                return i;
+            }
+            ++matches;
+        }
+    }
+    return first_only ? count : matches;
+}
+
+#if VECTOR_SEARCH_X86
+
+// The vector kernels compare bytes, so a block's compare mask has one bit per byte. An element of
+// width bytes matches if all of its bits are set; fold each element's bits down onto its first bit
+// and keep only those bits.
+static inline uint64_t element_matches(uint64_t mask, const size_t width, const uint64_t first_bits) {
+    for (size_t shift = 1; shift < width; shift <<= 1) {
+        mask &= mask >> shift;
+    }
+    return mask & first_bits;
+}
+
+static uint64_t first_bits_for_width(const size_t width) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < 64; i += width) {
+        bits |= (uint64_t)1 << i;
+    }
+    return bits;
+}
+
+// Fill a 64-byte pattern with repeated copies of a value of 1, 2, 4 or 8 bytes.
+static void fill_pattern(char pattern[64], const size_t width, const char *value) {
+    for (size_t i = 0; i < 64; i += width) {
+        memcpy(pattern + i, value, width);
+    }
+}
+
+// Generates a match kernel that compares BLOCK bytes at a time. COMPARE(block_pointer, pattern)
+// must evaluate to a mask with one bit per byte.
+#define MATCH_KERNEL(name, target, BLOCK, PATTERN_TYPE, LOAD_PATTERN, COMPARE) \
+    target static size_t name(const char *data, size_t count, size_t width, const char *value, bool first_only) { \
+        char pattern_bytes[64]; \
+        fill_pattern(pattern_bytes, width, value); \
+        const PATTERN_TYPE pattern = LOAD_PATTERN(pattern_bytes); \
+        const uint64_t first_bits = first_bits_for_width(width); \
+        const size_t per_block = (BLOCK) / width; \
+        const size_t num_blocks = count / per_block; \
+        size_t matches = 0; \
+        for (size_t block = 0; block < num_blocks; ++block) { \
+            const uint64_t mask = (uint64_t)(COMPARE(data + block * (BLOCK), pattern)); \
+            const uint64_t hits = element_matches(mask, width, first_bits); \
+            if (hits) { \
+                if (first_only) { \
+                    return block * per_block + (size_t)__builtin_ctzll(hits) / width; \
+                } \
+                matches += (size_t)__builtin_popcountll(hits); \
+            } \
+        } \
+        const size_t done = num_blocks * per_block; \
+        const size_t rest = match_scalar(data + done * width, count - done, width, value, first_only); \
+        return first_only ? done + rest : matches + rest; \
+    }
+
+#define SSE2_LOAD_PATTERN(p) _mm_loadu_si128((const __m128i *)(p))
+#define SSE2_COMPARE(p, pattern) \
+    (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p)), pattern))
+MATCH_KERNEL(match_sse2, __attribute__((target("sse2"))), 16, __m128i, SSE2_LOAD_PATTERN, SSE2_COMPARE)
+
+#define AVX2_LOAD_PATTERN(p) _mm256_loadu_si256((const __m256i *)(p))
+#define AVX2_COMPARE(p, pattern) \
+    (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p)), pattern))
+MATCH_KERNEL(match_avx2, __attribute__((target("avx2"))), 32, __m256i, AVX2_LOAD_PATTERN, AVX2_COMPARE)
+
+#define AVX512_LOAD_PATTERN(p) _mm512_loadu_si512((const void *)(p))
+#define AVX512_COMPARE(p, pattern) _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void *)(p)), pattern)
+MATCH_KERNEL(match_avx512, __attribute__((target("avx512f,avx512bw"))), 64, __m512i, AVX512_LOAD_PATTERN, AVX512_COMPARE)
+
+#endif
+
+static match_kernel_t match_kernel(const size_t width) {
+#if VECTOR_SEARCH_X86
+    if (width == 1 || width == 2 || width == 4 || width == 8) {
+        switch (best_isa()) {
+            case ISA_AVX512: return match_avx512;
+            case ISA_AVX2:   return match_avx2;
+            case ISA_SSE2:   return match_sse2;
+            default:         break;
+        }
+    }
+#endif
+    return match_scalar;
+}
+
+// Generates a scalar extreme kernel for type T.
+#define SCALAR_EXTREME_KERNEL(name, T) \
+    static void name(const void *data, size_t count, bool max, void *result) { \
+        const T *values = data; \
+        T extreme = values[0]; \
+        if (max) { \
+            for (size_t i = 1; i < count; ++i) { \
+                extreme = values[i] > extreme ? values[i] : extreme; \
+            } \
+        } else { \
+            for (size_t i = 1; i < count; ++i) { \
+                extreme = values[i] < extreme ? values[i] : extreme; \
+            } \
+        } \
+        *(T *)result = extreme; \
+    }
+
+SCALAR_EXTREME_KERNEL(extreme_scalar_i8, int8_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_u8, uint8_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_i16, int16_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_u16, uint16_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_i32, int32_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_u32, uint32_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_i64, int64_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_u64, uint64_t)
+SCALAR_EXTREME_KERNEL(extreme_scalar_f32, float)
+SCALAR_EXTREME_KERNEL(extreme_scalar_f64, double)
+
+#if VECTOR_SEARCH_X86
+
+// Generates a vector extreme kernel for type T that keeps LANES running minima or maxima in a
+// register of type V, then reduces the lanes and the tail with scalar code.
+#define VECTOR_EXTREME_KERNEL(name, target, T, V, LANES, LOAD, STORE, MIN, MAX, SCALAR) \
+    target static void name(const void *data, size_t count, bool max, void *result) { \
+        const T *values = data; \
+        if (count < 2 * (LANES)) { \
+            SCALAR(data, count, max, result); \
+            return; \
+        } \
+        V acc = LOAD(values); \
+        size_t i = (LANES); \
+        if (max) { \
+            for (; i + (LANES) <= count; i += (LANES)) { \
+                acc = MAX(acc, LOAD(values + i)); \
+            } \
+        } else { \
+            for (; i + (LANES) <= count; i += (LANES)) { \
+                acc = MIN(acc, LOAD(values + i)); \
+            } \
+        } \
+        T lanes[(LANES)]; \
+        STORE(lanes, acc); \
+        T extreme = lanes[0]; \
+        for (size_t j = 1; j < (LANES); ++j) { \
+            extreme = max ? (lanes[j] > extreme ? lanes[j] : extreme) : (lanes[j] < extreme ? lanes[j] : extreme); \
+        } \
+        if (i < count) { \
+            T tail; \
+            SCALAR(values + i, count - i, max, &tail); \
+            extreme = max ? (tail > extreme ? tail : extreme) : (tail < extreme ? tail : extreme); \
+        } \
+        *(T *)result = extreme; \
+    }
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define SSE2_LOADI(p) _mm_loadu_si128((const __m128i *)(p))
+#define SSE2_STOREI(p, v) _mm_storeu_si128((__m128i *)(p), v)
+VECTOR_EXTREME_KERNEL(extreme_sse2_u8, SSE2_TARGET, uint8_t, __m128i, 16, SSE2_LOADI, SSE2_STOREI, _mm_min_epu8, _mm_max_epu8, extreme_scalar_u8)
+VECTOR_EXTREME_KERNEL(extreme_sse2_i16, SSE2_TARGET, int16_t, __m128i, 8, SSE2_LOADI, SSE2_STOREI, _mm_min_epi16, _mm_max_epi16, extreme_scalar_i16)
+VECTOR_EXTREME_KERNEL(extreme_sse2_f32, SSE2_TARGET, float, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_min_ps, _mm_max_ps, extreme_scalar_f32)
+VECTOR_EXTREME_KERNEL(extreme_sse2_f64, SSE2_TARGET, double, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_min_pd, _mm_max_pd, extreme_scalar_f64)
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX2_LOADI(p) _mm256_loadu_si256((const __m256i *)(p))
+#define AVX2_STOREI(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+VECTOR_EXTREME_KERNEL(extreme_avx2_i8, AVX2_TARGET, int8_t, __m256i, 32, AVX2_LOADI, AVX2_STOREI, _mm256_min_epi8, _mm256_max_epi8, extreme_scalar_i8)
+VECTOR_EXTREME_KERNEL(extreme_avx2_u8, AVX2_TARGET, uint8_t, __m256i, 32, AVX2_LOADI, AVX2_STOREI, _mm256_min_epu8, _mm256_max_epu8, extreme_scalar_u8)
+VECTOR_EXTREME_KERNEL(extreme_avx2_i16, AVX2_TARGET, int16_t, __m256i, 16, AVX2_LOADI, AVX2_STOREI, _mm256_min_epi16, _mm256_max_epi16, extreme_scalar_i16)
+VECTOR_EXTREME_KERNEL(extreme_avx2_u16, AVX2_TARGET, uint16_t, __m256i, 16, AVX2_LOADI, AVX2_STOREI, _mm256_min_epu16, _mm256_max_epu16, extreme_scalar_u16)
+VECTOR_EXTREME_KERNEL(extreme_avx2_i32, AVX2_TARGET, int32_t, __m256i, 8, AVX2_LOADI, AVX2_STOREI, _mm256_min_epi32, _mm256_max_epi32, extreme_scalar_i32)
+VECTOR_EXTREME_KERNEL(extreme_avx2_u32, AVX2_TARGET, uint32_t, __m256i, 8, AVX2_LOADI, AVX2_STOREI, _mm256_min_epu32, _mm256_max_epu32, extreme_scalar_u32)
+VECTOR_EXTREME_KERNEL(extreme_avx2_f32, AVX2_TARGET, float, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_min_ps, _mm256_max_ps, extreme_scalar_f32)
+VECTOR_EXTREME_KERNEL(extreme_avx2_f64, AVX2_TARGET, double, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_min_pd, _mm256_max_pd, extreme_scalar_f64)
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+#define AVX512_LOADI(p) _mm512_loadu_si512((const void *)(p))
+#define AVX512_STOREI(p, v) _mm512_storeu_si512((void *)(p), v)
+VECTOR_EXTREME_KERNEL(extreme_avx512_i8, AVX512_TARGET, int8_t, __m512i, 64, AVX512_LOADI, AVX512_STOREI, _mm512_min_epi8, _mm512_max_epi8, extreme_scalar_i8)
+VECTOR_EXTREME_KERNEL(extreme_avx512_u8, AVX512_TARGET, uint8_t, __m512i, 64, AVX512_LOADI, AVX512_STOREI, _mm512_min_epu8, _mm512_max_epu8, extreme_scalar_u8)
+VECTOR_EXTREME_KERNEL(extreme_avx512_i16, AVX512_TARGET, int16_t, __m512i, 32, AVX512_LOADI, AVX512_STOREI, _mm512_min_epi16, _mm512_max_epi16, extreme_scalar_i16)
+VECTOR_EXTREME_KERNEL(extreme_avx512_u16, AVX512_TARGET, uint16_t, __m512i, 32, AVX512_LOADI, AVX512_STOREI, _mm512_min_epu16, _mm512_max_epu16, extreme_scalar_u16)
+VECTOR_EXTREME_KERNEL(extreme_avx512_i32, AVX512_TARGET, int32_t, __m512i, 16, AVX512_LOADI, AVX512_STOREI, _mm512_min_epi32, _mm512_max_epi32, extreme_scalar_i32)
+VECTOR_EXTREME_KERNEL(extreme_avx512_u32, AVX512_TARGET, uint32_t, __m512i, 16, AVX512_LOADI, AVX512_STOREI, _mm512_min_epu32, _mm512_max_epu32, extreme_scalar_u32)
+VECTOR_EXTREME_KERNEL(extreme_avx512_i64, AVX512_TARGET, int64_t, __m512i, 8, AVX512_LOADI, AVX512_STOREI, _mm512_min_epi64, _mm512_max_epi64, extreme_scalar_i64)
+VECTOR_EXTREME_KERNEL(extreme_avx512_u64, AVX512_TARGET, uint64_t, __m512i, 8, AVX512_LOADI, AVX512_STOREI, _mm512_min_epu64, _mm512_max_epu64, extreme_scalar_u64)
+VECTOR_EXTREME_KERNEL(extreme_avx512_f32, AVX512_TARGET, float, __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_min_ps, _mm512_max_ps, extreme_scalar_f32)
+VECTOR_EXTREME_KERNEL(extreme_avx512_f64, AVX512_TARGET, double, __m512d, 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_min_pd, _mm512_max_pd, extreme_scalar_f64)
+
+#   define SSE2_KERNEL(k) k
+#   define AVX2_KERNEL(k) k
+#   define AVX512_KERNEL(k) k
+#else
+#   define SSE2_KERNEL(k) NULL
+#   define AVX2_KERNEL(k) NULL
+#   define AVX512_KERNEL(k) NULL
+#endif
+
+typedef struct scalar_type_info_t {
+    size_t size;
+    extreme_kernel_t extreme_kernels[ISA_COUNT];
+} scalar_type_info_t;
+
+// Indexed by vector_scalar_type_t, then by isa_t. NULL entries fall back to the next lower level.
+static const scalar_type_info_t SCALAR_TYPE_INFO[] = {
+    { sizeof(int8_t),   { extreme_scalar_i8,  NULL, AVX2_KERNEL(extreme_avx2_i8), AVX512_KERNEL(extreme_avx512_i8) } },
+    { sizeof(uint8_t),  { extreme_scalar_u8,  SSE2_KERNEL(extreme_sse2_u8), AVX2_KERNEL(extreme_avx2_u8), AVX512_KERNEL(extreme_avx512_u8) } },
+    { sizeof(int16_t),  { extreme_scalar_i16, SSE2_KERNEL(extreme_sse2_i16), AVX2_KERNEL(extreme_avx2_i16), AVX512_KERNEL(extreme_avx512_i16) } },
+    { sizeof(uint16_t), { extreme_scalar_u16, NULL, AVX2_KERNEL(extreme_avx2_u16), AVX512_KERNEL(extreme_avx512_u16) } },
+    { sizeof(int32_t),  { extreme_scalar_i32, NULL, AVX2_KERNEL(extreme_avx2_i32), AVX512_KERNEL(extreme_avx512_i32) } },
+    { sizeof(uint32_t), { extreme_scalar_u32, NULL, AVX2_KERNEL(extreme_avx2_u32), AVX512_KERNEL(extreme_avx512_u32) } },
+    { sizeof(int64_t),  { extreme_scalar_i64, NULL, NULL, AVX512_KERNEL(extreme_avx512_i64) } },
+    { sizeof(uint64_t), { extreme_scalar_u64, NULL, NULL, AVX512_KERNEL(extreme_avx512_u64) } },
+    { sizeof(float),    { extreme_scalar_f32, SSE2_KERNEL(extreme_sse2_f32), AVX2_KERNEL(extreme_avx2_f32), AVX512_KERNEL(extreme_avx512_f32) } },
+    { sizeof(double),   { extreme_scalar_f64, SSE2_KERNEL(extreme_sse2_f64), AVX2_KERNEL(extreme_avx2_f64), AVX512_KERNEL(extreme_avx512_f64) } },
+};
+
+static extreme_kernel_t extreme_kernel(const vector_scalar_type_t type) {
+    const scalar_type_info_t *info = &SCALAR_TYPE_INFO[type];
+    for (int isa = best_isa(); isa > ISA_SCALAR; --isa) {
+        if (info->extreme_kernels[isa]) {
+            return info->extreme_kernels[isa];
+        }
+    }
+    return info->extreme_kernels[ISA_SCALAR];
+}
+
+static size_t extreme_index(const vector_t *vector, const vector_scalar_type_t type, const bool max) {
+    VECTOR_CHECK(vector && type <= VECTOR_SCALAR_DOUBLE);
+    VECTOR_CHECK(vector_element_size(vector) == vector_scalar_type_size(type));
+    const size_t size = vector_size(vector);
+    if (size == 0) {
+        return size;
+    }
+    const char *data = vector_data(vector);
+    const size_t width = vector_element_size(vector);
+    char extreme[sizeof(uint64_t)];
+    extreme_kernel(type)(data, size, max, extreme);
+    return match_kernel(width)(data, size, width, extreme, true);
+}
+
+size_t vector_scalar_type_size(const vector_scalar_type_t type) {
+    VECTOR_CHECK(type <= VECTOR_SCALAR_DOUBLE);
+    return SCALAR_TYPE_INFO[type].size;
+}
+
+size_t vector_find(const vector_t *vector, const void *value) {
+    VECTOR_CHECK(vector && value);
+    const size_t size = vector_size(vector);
+    if (size == 0) {
+        return size;
+    }
+    const size_t width = vector_element_size(vector);
+    return match_kernel(width)(vector_data(vector), size, width, value, true);
+}
+
+size_t vector_count(const vector_t *vector, const void *value) {
+    VECTOR_CHECK(vector && value);
+    const size_t size = vector_size(vector);
+    if (size == 0) {
+        return 0;
+    }
+    const size_t width = vector_element_size(vector);
+    return match_kernel(width)(vector_data(vector), size, width, value, false);
+}
+
+size_t vector_min_index(const vector_t *vector, const vector_scalar_type_t type) {
+    return extreme_index(vector, type, false);
+}
+
+size_t vector_max_index(const vector_t *vector, const vector_scalar_type_t type) {
+    return extreme_index(vector, type, true);
+}
@@ -0,0 +1,105 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_SEARCH_H
+#define VECTOR_SEARCH_H
+
+/**
+ @file vector_search.h
+
+ Linear searches over the elements of a vector (optional).
+
+ On x86 processors compiled with GCC or Clang, the searches use SSE2, AVX2 or AVX-512 kernels
+ chosen at runtime for the processor the program is running on. Elsewhere, and for element sizes
+ without a vector kernel, they fall back to portable scalar loops.
+ */
+
+#include "vector.h"
+
+/** The scalar types that @c vector_min_index() and @c vector_max_index() understand. */
+typedef enum vector_scalar_type_t {
+    VECTOR_SCALAR_INT8,
+    VECTOR_SCALAR_UINT8,
+    VECTOR_SCALAR_INT16,
+    VECTOR_SCALAR_UINT16,
+    VECTOR_SCALAR_INT32,
+    VECTOR_SCALAR_UINT32,
+    VECTOR_SCALAR_INT64,
+    VECTOR_SCALAR_UINT64,
+    VECTOR_SCALAR_FLOAT,
+    VECTOR_SCALAR_DOUBLE,
+} vector_scalar_type_t;
+
+/**
+ Return the size in bytes of a scalar type.
+
+ @param type A scalar type.
+
+ @return The size of @c type in bytes.
+ */
+VECTOR_EXTERN size_t vector_scalar_type_size(const vector_scalar_type_t type);
+
+/**
+ Find the first element of a vector equal to a value.
+
+ Elements are compared bytewise, like memcmp(), so e.g. floating-point -0.0 and 0.0 are different.
+
+ @param vector A vector.
+ @param value  A pointer to the value to find of at least @c element_size bytes.
+
+ @return The index of the first matching element, or the vector's size if there is none.
+ */
+VECTOR_EXTERN size_t vector_find(const vector_t *vector, const void *value);
+
+/**
+ Count the elements of a vector equal to a value.
+
+ Elements are compared bytewise, like memcmp().
+
+ @param vector A vector.
+ @param value  A pointer to the value to count of at least @c element_size bytes.
+
+ @return The number of matching elements.
+ */
+VECTOR_EXTERN size_t vector_count(const vector_t *vector, const void *value);
+
+/**
+ Find the smallest element of a vector of scalars.
+
+ The vector's element size must match the size of @c type. The result is unspecified if a
+ floating-point vector contains NaNs.
+
+ @param vector A vector.
+ @param type   The type of the vector's elements.
+
+ @return The index of the first element equal to the minimum, or the vector's size if it is empty.
+ */
+VECTOR_EXTERN size_t vector_min_index(const vector_t *vector, const vector_scalar_type_t type);
+
+/**
+ Find the largest element of a vector of scalars.
+
+ The vector's element size must match the size of @c type. The result is unspecified if a
+ floating-point vector contains NaNs.
+
+ @param vector A vector.
+ @param type   The type of the vector's elements.
+
+ @return The index of the first element equal to the maximum, or the vector's size if it is empty.
+ */
+VECTOR_EXTERN size_t vector_max_index(const vector_t *vector, const vector_scalar_type_t type);
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_soa.h"
+#include "vector_check.h"
+#include "vector_system_internal.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+typedef struct column_t {
+    size_t field_size;
+    char *data;
+} column_t;
+
+// All columns live in one allocation starting at storage, each padded to the column alignment.
+struct vector_soa_t {
+    size_t size;
+    size_t capacity;
+    void *storage;
+    size_t field_count;
+    column_t columns[];
+};
+
+static inline size_t align_up(const size_t n) {
+    return (n + VECTOR_SOA_ALIGNMENT - 1) & ~(size_t)(VECTOR_SOA_ALIGNMENT - 1);
+}
+
+static inline char *field_pointer(const vector_soa_t *soa, const size_t field, const size_t index) {
+    return soa->columns[field].data + index * soa->columns[field].field_size;
+}
+
+// The number of bytes needed for every column at a capacity, or zero on overflow.
+static size_t storage_size(const vector_soa_t *soa, const size_t capacity) {
+    size_t total = VECTOR_SOA_ALIGNMENT - 1;
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        const size_t field_size = soa->columns[i].field_size;
+        if (capacity > (SIZE_MAX - total) / field_size) {
+            return 0;
+        }
+        const size_t column_size = align_up(capacity * field_size);
+        if (column_size > SIZE_MAX - total) {
+            return 0;
+        }
+        total += column_size;
+    }
+    return total;
+}
+
+static size_t capacity_for_size(const size_t capacity, const size_t size) {
+    size_t new_capacity = capacity > 0 ? capacity : 1;
+    while (new_capacity < size) {
+        new_capacity = new_capacity > SIZE_MAX / 2 ? size : new_capacity * 2;
+    }
+    return new_capacity;
+}
+
+vector_soa_t *vector_soa_create(const size_t field_count, const size_t *field_sizes) {
+    VECTOR_CHECK(field_count > 0 && field_sizes);
+    vector_soa_t *soa = vector_system_realloc(NULL, sizeof(vector_soa_t) + field_count * sizeof(column_t));
+    if (soa) {
+        soa->size = 0;
+        soa->capacity = 0;
+        soa->storage = NULL;
+        soa->field_count = field_count;
+        for (size_t i = 0; i < field_count; ++i) {
+            VECTOR_CHECK(field_sizes[i] > 0);
+            soa->columns[i].field_size = field_sizes[i];
+            soa->columns[i].data = NULL;
+        }
+    }
+    return soa;
+}
+
+void vector_soa_destroy(vector_soa_t *soa) {
+    VECTOR_CHECK(soa);
+    vector_system_free(soa->storage);
+    vector_system_free(soa);
+}
+
+size_t vector_soa_field_count(const vector_soa_t *soa) {
+    VECTOR_CHECK(soa);
+    return soa->field_count;
+}
+
+size_t vector_soa_field_size(const vector_soa_t *soa, const size_t field) {
+    VECTOR_CHECK(soa && field < soa->field_count);
+    return soa->columns[field].field_size;
+}
+
+bool vector_soa_empty(const vector_soa_t *soa) {
+    VECTOR_CHECK(soa);
+    return soa->size == 0;
+}
+
+size_t vector_soa_size(const vector_soa_t *soa) {
+    VECTOR_CHECK(soa);
+    return soa->size;
+}
+
+size_t vector_soa_capacity(const vector_soa_t *soa) {
+    VECTOR_CHECK(soa);
+    return soa->capacity;
+}
+
+void vector_soa_reserve(vector_soa_t *soa, const size_t capacity) {
+    VECTOR_CHECK(soa);
+    if (soa->capacity >= capacity) {
+        return;
+    }
+    const size_t num_bytes = storage_size(soa, capacity);
+    void *new_storage = num_bytes > 0 ? vector_system_realloc(NULL, num_bytes) : NULL;
+    if (!new_storage) {
+        vector_system_fprintf(stderr, "Could not allocate %zu records.", capacity);
+        vector_system_abort();
+        return;
+    }
+    char *column = (char *)align_up((uintptr_t)new_storage);
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        const size_t field_size = soa->columns[i].field_size;
+        if (soa->size > 0) {
+            vector_system_memcpy(column, soa->columns[i].data, soa->size * field_size);
+        }
+        soa->columns[i].data = column;
+        column += align_up(capacity * field_size);
+    }
+    vector_system_free(soa->storage);
+    soa->storage = new_storage;
+    soa->capacity = capacity;
+}
+
+void vector_soa_clear(vector_soa_t *soa) {
+    VECTOR_CHECK(soa);
+    soa->size = 0;
+}
+
+void vector_soa_resize(vector_soa_t *soa, const size_t size) {
+    VECTOR_CHECK(soa);
+    vector_soa_reserve(soa, size);
+    if (soa->capacity >= size) {
+        soa->size = size;
+    }
+}
+
+void *vector_soa_data(const vector_soa_t *soa, const size_t field) {
+    VECTOR_CHECK(soa && field < soa->field_count);
+    return soa->columns[field].data;
+}
+
+void *vector_soa_get(const vector_soa_t *soa, const size_t field, const size_t index) {
+    VECTOR_CHECK(soa && field < soa->field_count && index < soa->size);
+    return field_pointer(soa, field, index);
+}
+
+void vector_soa_push_back(vector_soa_t *soa, const void *const *values) {
+    VECTOR_CHECK(soa);
+    vector_soa_insert(soa, soa->size, values);
+}
+
+void vector_soa_insert(vector_soa_t *soa, const size_t pos, const void *const *values) {
+    VECTOR_CHECK(soa && values && pos <= soa->size);
+    if (!values || pos > soa->size) {
+        return;
+    }
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        VECTOR_CHECK(values[i]);
+        if (!values[i]) {
+            return;
+        }
+    }
+    vector_soa_reserve(soa, capacity_for_size(soa->capacity, soa->size + 1));
+    if (soa->capacity <= soa->size) {
+        return;
+    }
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        const size_t field_size = soa->columns[i].field_size;
+        if (pos < soa->size) {
+            vector_system_memmove(field_pointer(soa, i, pos + 1), field_pointer(soa, i, pos), (soa->size - pos) * field_size);
+        }
+        vector_system_memcpy(field_pointer(soa, i, pos), values[i], field_size);
+    }
+    ++soa->size;
+}
+
+void vector_soa_erase(vector_soa_t *soa, const size_t pos) {
+    VECTOR_CHECK(soa && pos < soa->size);
+    if (pos < soa->size) {
+        for (size_t i = 0; i < soa->field_count; ++i) {
+            const size_t count = soa->size - pos - 1;
+            if (count > 0) {
+                vector_system_memmove(field_pointer(soa, i, pos), field_pointer(soa, i, pos + 1),
+                                      count * soa->columns[i].field_size);
+            }
+        }
+        --soa->size;
+    }
+}
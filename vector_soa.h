@@ -0,0 +1,193 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_SOA_H
+#define VECTOR_SOA_H
+
+/**
+ @file vector_soa.h
+
+ A variable-length structure of arrays (optional).
+
+ A @c vector_t stores whole records one after the other. A @c vector_soa_t instead stores each
+ field of its records in its own contiguous column, so a scan that reads only a few fields of each
+ record touches only those columns. All columns share one size and capacity and grow together.
+
+ Each column starts on a @c VECTOR_SOA_ALIGNMENT byte boundary.
+ */
+
+#include "vector.h"
+
+/** The alignment in bytes of each column's storage. */
+#define VECTOR_SOA_ALIGNMENT 64
+
+/** An anonymous structure for storing a structure of arrays' state. */
+struct vector_soa_t;
+
+/** A sequence of records stored as one column per field. */
+typedef struct vector_soa_t vector_soa_t;
+
+/**
+ Create an empty structure of arrays.
+
+ @param field_count The number of fields in a record.
+ @param field_sizes An array of @c field_count sizes in bytes, all greater than zero.
+
+ @return A new initialized structure of arrays.
+ */
+VECTOR_EXTERN vector_soa_t *vector_soa_create(const size_t field_count, const size_t *field_sizes);
+
+/**
+ Destroy a structure of arrays and deallocate its memory.
+
+ @param soa A structure of arrays.
+ */
+VECTOR_EXTERN void vector_soa_destroy(vector_soa_t *soa);
+
+/**
+ Return the number of fields in a record.
+
+ @param soa A structure of arrays.
+
+ @return The number of columns.
+ */
+VECTOR_EXTERN size_t vector_soa_field_count(const vector_soa_t *soa);
+
+/**
+ Return the size of a field.
+
+ @param soa   A structure of arrays.
+ @param field A field index in the range of [0, field_count - 1].
+
+ @return The size of the field in bytes.
+ */
+VECTOR_EXTERN size_t vector_soa_field_size(const vector_soa_t *soa, const size_t field);
+
+/**
+ Return if a structure of arrays is empty.
+
+ @param soa A structure of arrays.
+
+ @return True if there are no records.
+ */
+VECTOR_EXTERN bool vector_soa_empty(const vector_soa_t *soa);
+
+/**
+ Return the number of records in a structure of arrays.
+
+ @param soa A structure of arrays.
+
+ @return The number of records.
+ */
+VECTOR_EXTERN size_t vector_soa_size(const vector_soa_t *soa);
+
+/**
+ Return the number of records a structure of arrays can grow to without reallocation.
+
+ @param soa A structure of arrays.
+
+ @return The capacity in records.
+ */
+VECTOR_EXTERN size_t vector_soa_capacity(const vector_soa_t *soa);
+
+/**
+ Ensure that a structure of arrays can grow to at least @c capacity records without reallocation.
+
+ If memory allocation fails, the global handler returned by @c vector_get_global_abort_func() is
+ called.
+
+ Invalidates column pointers if @c capacity is greater than the current capacity.
+
+ @param soa      A structure of arrays.
+ @param capacity The new capacity.
+ */
+VECTOR_EXTERN void vector_soa_reserve(vector_soa_t *soa, const size_t capacity);
+
+/**
+ Remove all records from a structure of arrays.
+
+ @param soa A structure of arrays.
+ */
+VECTOR_EXTERN void vector_soa_clear(vector_soa_t *soa);
+
+/**
+ Resize a structure of arrays.
+
+ If @c size is greater than the current size, the fields of the new records will be uninitialized.
+
+ Invalidates column pointers if @c size is greater than the current capacity.
+
+ @param soa  A structure of arrays.
+ @param size The new number of records.
+ */
+VECTOR_EXTERN void vector_soa_resize(vector_soa_t *soa, const size_t size);
+
+/**
+ Return a pointer to a column's storage.
+
+ The returned pointer is aligned to @c VECTOR_SOA_ALIGNMENT bytes and valid until a reallocation
+ occurs.
+
+ @param soa   A structure of arrays.
+ @param field A field index in the range of [0, field_count - 1].
+
+ @return A pointer to at least @c field_size x @c size bytes.
+ */
+VECTOR_EXTERN void *vector_soa_data(const vector_soa_t *soa, const size_t field);
+
+/**
+ Get one field of a record.
+
+ @param soa   A structure of arrays.
+ @param field A field index in the range of [0, field_count - 1].
+ @param index A record index in the range of [0, size - 1].
+
+ @return A pointer to the field.
+ */
+VECTOR_EXTERN void *vector_soa_get(const vector_soa_t *soa, const size_t field, const size_t index);
+
+/**
+ Append a record, increasing the size by one.
+
+ Invalidates column pointers if the current size plus one is greater than the capacity.
+
+ @param soa    A structure of arrays.
+ @param values An array of @c field_count pointers to the new record's field values.
+ */
+VECTOR_EXTERN void vector_soa_push_back(vector_soa_t *soa, const void *const *values);
+
+/**
+ Insert a record.
+
+ Records with indices greater than or equal to @c pos are shifted in every column to make room.
+
+ Invalidates column pointers if the current size plus one is greater than the capacity.
+
+ @param soa    A structure of arrays.
+ @param pos    The index of the new record.
+ @param values An array of @c field_count pointers to the new record's field values.
+ */
+VECTOR_EXTERN void vector_soa_insert(vector_soa_t *soa, const size_t pos, const void *const *values);
+
+/**
+ Erase a record, decreasing the size by one.
+
+ @param soa A structure of arrays.
+ @param pos The index of the record to erase.
+ */
+VECTOR_EXTERN void vector_soa_erase(vector_soa_t *soa, const size_t pos);
+
+#endif
@@ -15,25 +15,126 @@
  */
 
 #include "vector_system.h"
+#include "vector_atomic.h"
+#include "vector_check.h"
 
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static vector_abort_func_t global_abort_func = vector_default_global_abort_func;
-static vector_free_func_t global_free_func = vector_default_global_free_func;
-static vector_memcpy_func_t global_memcpy_func = vector_default_global_memcpy_func;
-static vector_memmove_func_t global_memmove_func = vector_default_global_memmove_func;
-static vector_realloc_func_t global_realloc_func = vector_default_global_realloc_func;
-static vector_vfprintf_func_t global_vfprintf_func = vector_default_global_vfprintf_func;
+#if defined(__GLIBC__)
+#   include <malloc.h>
+#endif
+
+// A published hook table. Readers may still be using a table after it has been replaced, so
+// replaced tables are never freed; they are kept on a list so they stay reachable.
+typedef struct hooks_node_t {
+    vector_hooks_t hooks;
+    struct hooks_node_t *retired;
+} hooks_node_t;
+
+static hooks_node_t default_hooks = {
+    {
+        vector_default_global_abort_func,
+        vector_default_global_free_func,
+        vector_default_global_memcpy_func,
+        vector_default_global_memmove_func,
+        vector_default_global_realloc_func,
+        vector_default_global_vfprintf_func,
+        NULL,
+        vector_default_global_try_expand_func,
+    },
+    NULL,
+};
+
+static hooks_node_t *global_hooks = &default_hooks;
+
+static inline const vector_hooks_t *load_hooks(void) {
+    return &VECTOR_ATOMIC_LOAD_ACQUIRE(&global_hooks)->hooks;
+}
+
+// Publish a copy of the current table with one hook changed by update(), retrying if another
+// thread published a table in the meantime.
+typedef void (*hooks_update_func_t)(vector_hooks_t *hooks, const void *arg);
+
+static void update_hooks(const hooks_update_func_t update, const void *arg) {
+    hooks_node_t *node = malloc(sizeof(hooks_node_t));
+    if (!node) {
+        vector_abort_func_t abort_func = load_hooks()->abort;
+        if (abort_func) {
+            abort_func();
+        }
+        return;
+    }
+    hooks_node_t *current = VECTOR_ATOMIC_LOAD_ACQUIRE(&global_hooks);
+    do {
+        node->hooks = current->hooks;
+        node->retired = current;
+        update(&node->hooks, arg);
+    } while (!VECTOR_ATOMIC_COMPARE_EXCHANGE(&global_hooks, &current, node));
+}
+
+static void update_all(vector_hooks_t *hooks, const void *arg) {
+    *hooks = *(const vector_hooks_t *)arg;
+}
+
+static void update_abort(vector_hooks_t *hooks, const void *arg) {
+    hooks->abort = *(const vector_abort_func_t *)arg;
+}
+
+static void update_free(vector_hooks_t *hooks, const void *arg) {
+    hooks->free = *(const vector_free_func_t *)arg;
+}
+
+static void update_memcpy(vector_hooks_t *hooks, const void *arg) {
+    hooks->memcpy = *(const vector_memcpy_func_t *)arg;
+}
+
+static void update_memmove(vector_hooks_t *hooks, const void *arg) {
+    hooks->memmove = *(const vector_memmove_func_t *)arg;
+}
+
+static void update_realloc(vector_hooks_t *hooks, const void *arg) {
+    hooks->realloc = *(const vector_realloc_func_t *)arg;
+    hooks->try_expand = hooks->realloc == vector_default_global_realloc_func ? vector_default_global_try_expand_func
+                                                                             : NULL;
+}
+
+static void update_vfprintf(vector_hooks_t *hooks, const void *arg) {
+    hooks->vfprintf = *(const vector_vfprintf_func_t *)arg;
+}
+
+static void update_grow(vector_hooks_t *hooks, const void *arg) {
+    hooks->grow = *(const vector_grow_func_t *)arg;
+}
+
+static void update_try_expand(vector_hooks_t *hooks, const void *arg) {
+    hooks->try_expand = *(const vector_try_expand_func_t *)arg;
+}
+
+static void print_message(vector_vfprintf_func_t vfprintf_func, FILE * restrict stream, const char * restrict format, ...) {
+    va_list arg_pointers;
+    va_start(arg_pointers, format);
+    vfprintf_func(stream, format, arg_pointers);
+    va_end(arg_pointers);
+}
+
+const vector_hooks_t *vector_get_global_hooks(void) {
+    return load_hooks();
+}
+
+void vector_set_global_hooks(const vector_hooks_t *hooks) {
+    VECTOR_CHECK(hooks);
+    update_hooks(update_all, hooks);
+}
 
 vector_abort_func_t vector_get_global_abort_func(void) {
-    return global_abort_func;
+    return load_hooks()->abort;
 }
 
 void vector_set_global_abort_func(const vector_abort_func_t abort_func) {
-    global_abort_func = abort_func;
+    update_hooks(update_abort, &abort_func);
 }
 
 void vector_default_global_abort_func() {
@@ -41,11 +142,11 @@ void vector_default_global_abort_func() {
 }
 
 vector_free_func_t vector_get_global_free_func(void) {
-    return global_free_func;
+    return load_hooks()->free;
 }
 
 void vector_set_global_free_func(const vector_free_func_t free_func) {
-    global_free_func = free_func;
+    update_hooks(update_free, &free_func);
 }
 
 void vector_default_global_free_func(void *ptr) {
@@ -53,11 +154,11 @@ void vector_default_global_free_func(void *ptr) {
 }
 
 vector_memcpy_func_t vector_get_global_memcpy_func(void) {
-    return global_memcpy_func;
+    return load_hooks()->memcpy;
 }
 
 void vector_set_global_memcpy_func(const vector_memcpy_func_t memcpy_func) {
-    global_memcpy_func = memcpy_func;
+    update_hooks(update_memcpy, &memcpy_func);
 }
 
 void *vector_default_global_memcpy_func(void *restrict dst, const void *restrict src, size_t n) {
@@ -65,11 +166,11 @@ void *vector_default_global_memcpy_func(void *restrict dst, const void *restrict
 }
 
 vector_memmove_func_t vector_get_global_memmove_func(void) {
-    return global_memmove_func;
+    return load_hooks()->memmove;
 }
 
 void vector_set_global_memmove_func(const vector_memmove_func_t memmove_func) {
-    global_memmove_func = memmove_func;
+    update_hooks(update_memmove, &memmove_func);
 }
 
 void *vector_default_global_memmove_func(void *dst, const void *src, size_t len) {
@@ -77,11 +178,11 @@ void *vector_default_global_memmove_func(void *dst, const void *src, size_t len)
 }
 
 vector_vfprintf_func_t vector_get_global_vfprintf_func(void) {
-    return global_vfprintf_func;
+    return load_hooks()->vfprintf;
 }
 
 void vector_set_global_vfprintf_func(const vector_vfprintf_func_t vfprintf_func) {
-    global_vfprintf_func = vfprintf_func;
+    update_hooks(update_vfprintf, &vfprintf_func);
 }
 
 int vector_default_global_vfprintf_func(FILE * restrict stream, const char * restrict format, va_list ap) {
@@ -89,14 +190,50 @@ int vector_default_global_vfprintf_func(FILE * restrict stream, const char * res
 }
 
 vector_realloc_func_t vector_get_global_realloc_func(void) {
-    return global_realloc_func;
+    return load_hooks()->realloc;
 }
 
 void vector_set_global_realloc_func(const vector_realloc_func_t realloc_func) {
-    global_realloc_func = realloc_func;
+    update_hooks(update_realloc, &realloc_func);
 }
 
 void *vector_default_global_realloc_func(void *ptr, size_t size) {
     return realloc(ptr, size);
 }
 
+vector_grow_func_t vector_get_global_grow_func(void) {
+    return load_hooks()->grow;
+}
+
+void vector_set_global_grow_func(const vector_grow_func_t grow_func) {
+    update_hooks(update_grow, &grow_func);
+}
+
+vector_try_expand_func_t vector_get_global_try_expand_func(void) {
+    return load_hooks()->try_expand;
+}
+
+void vector_set_global_try_expand_func(const vector_try_expand_func_t try_expand_func) {
+    update_hooks(update_try_expand, &try_expand_func);
+}
+
+bool vector_default_global_try_expand_func(void *ptr, size_t size) {
+#if defined(__GLIBC__)
+    return malloc_usable_size(ptr) >= size;
+#else
+    (void)ptr;
+    (void)size;
+    return false;
+#endif
+}
+
+void vector_check_failed(const char *condition, const char *file, int line) {
+    vector_vfprintf_func_t vfprintf_func = vector_get_global_vfprintf_func();
+    if (vfprintf_func) {
+        print_message(vfprintf_func, stderr, "%s:%d: vector check failed: %s\n", file, line, condition);
+    }
+    vector_abort_func_t abort_func = vector_get_global_abort_func();
+    if (abort_func) {
+        abort_func();
+    }
+}
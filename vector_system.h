@@ -26,9 +26,10 @@
  for example, memory allocation, printing error messages, etc. The vector_t library allows you to
  redefine the methods it uses for:
 
- - Memory allocation and deallocation,
- - Aborting in situations where the library can't continue, and,
- - Printing error messages.
+ - Memory allocation, in-place growth and deallocation,
+ - Aborting in situations where the library can't continue,
+ - Printing error messages, and,
+ - Observing vectors' storage growing.
 
  The functions in this file allow you to redefine these methods and provides the default functions
  vector_t uses. The default functions simply call the standard C99 functions, for example, @c
@@ -57,9 +58,70 @@ typedef void *(*vector_memmove_func_t)(void *dst, const void *src, size_t len);
 /** A function that attempts to reallocate a memory block, similar to realloc(3). */
 typedef void *(*vector_realloc_func_t)(void *ptr, size_t size);
 
+/**
+ A function that attempts to grow a memory block in place, without moving it.
+
+ @param ptr  A block allocated by the library's realloc() function.
+ @param size The number of bytes the block needs to hold.
+
+ @return @c true if @c ptr now holds at least @c size bytes, or @c false if the block could not be
+         grown in place, in which case it is unchanged.
+ */
+typedef bool (*vector_try_expand_func_t)(void *ptr, size_t size);
+
 /** A function that prints a formatted string to a stream with a variadic argument list, similar to vfprintf(3). */
 typedef int (*vector_vfprintf_func_t)(FILE * restrict stream, const char * restrict format, va_list ap);
 
+/**
+ A function that observes a vector's storage growing.
+
+ @param vector       The vector, after its storage has grown.
+ @param call_site    The return address of the library function that caused the growth, or @c NULL
+                     if the compiler cannot provide it.
+ @param old_capacity The vector's capacity before growing.
+ @param new_capacity The vector's capacity after growing.
+ */
+typedef void (*vector_grow_func_t)(const vector_t *vector, const void *call_site, size_t old_capacity,
+                                   size_t new_capacity);
+
+/**
+ The complete set of functions the library uses to interact with the system.
+
+ The library keeps the current functions in a single table that is replaced atomically, so a table
+ fetched with vector_get_global_hooks() is always consistent and the functions can be replaced
+ while other threads are using the library. Tables that have been replaced are never freed, so
+ changing the functions is meant to be rare.
+ */
+typedef struct vector_hooks_t {
+    vector_abort_func_t abort;          /**< Acts like abort(). */
+    vector_free_func_t free;            /**< Acts like free(). */
+    vector_memcpy_func_t memcpy;        /**< Acts like memcpy(). */
+    vector_memmove_func_t memmove;      /**< Acts like memmove(). */
+    vector_realloc_func_t realloc;      /**< Acts like realloc(). */
+    vector_vfprintf_func_t vfprintf;    /**< Acts like vfprintf(). */
+    vector_grow_func_t grow;            /**< Observes growth, or @c NULL. */
+    vector_try_expand_func_t try_expand; /**< Grows blocks from @c realloc in place, or @c NULL. */
+} vector_hooks_t;
+
+/**
+ Return all of the library's system functions with a single atomic load.
+
+ @return The current table of functions. The table is never modified or freed.
+ */
+VECTOR_EXTERN const vector_hooks_t *vector_get_global_hooks(void);
+
+/**
+ Replace all of the library's system functions at once.
+
+ The table is copied, and other threads see either all of the old functions or all of the new
+ ones. This is the safe way to switch between functions that must be used together, such as a
+ realloc() and free() pair, while the library is in use. Note that memory must still be freed by
+ the free() function matching the realloc() function that allocated it.
+
+ @param hooks The new functions.
+ */
+VECTOR_EXTERN void vector_set_global_hooks(const vector_hooks_t *hooks);
+
 /**
  Return the library's abort() function.
 
@@ -166,6 +228,11 @@ VECTOR_EXTERN vector_realloc_func_t vector_get_global_realloc_func(void);
  block. Memory allocated by this function will be deallocated by the function returned by
  @c vector_get_global_free_func().
 
+ The try-expand function only understands blocks from a particular realloc() function, so setting
+ the realloc() function also sets the try-expand function: to the default if @c realloc_func is
+ @c vector_default_global_realloc_func(), and to none otherwise. Set a matching try-expand function
+ afterwards, or set both at once with vector_set_global_hooks().
+
  @param realloc_func A function that acts like realloc().
  */
 VECTOR_EXTERN void vector_set_global_realloc_func(const vector_realloc_func_t realloc_func);
@@ -200,4 +267,48 @@ VECTOR_EXTERN void vector_set_global_vfprintf_func(const vector_vfprintf_func_t
  */
 VECTOR_EXTERN int vector_default_global_vfprintf_func(FILE * restrict stream, const char * restrict format, va_list ap);
 
+/**
+ Return the library's grow function.
+
+ @return The function called when a vector's storage grows, or @c NULL if there is none.
+ */
+VECTOR_EXTERN vector_grow_func_t vector_get_global_grow_func(void);
+
+/**
+ Set the library's grow function.
+
+ Called after a vector's storage has been reallocated to a larger capacity, for example to find
+ the code paths that cause the most reallocation. There is no grow function by default.
+
+ @param grow_func A function to observe growth, or @c NULL for none.
+ */
+VECTOR_EXTERN void vector_set_global_grow_func(const vector_grow_func_t grow_func);
+
+/**
+ Return the library's try-expand function.
+
+ @return The function used to grow storage in place, or @c NULL if there is none.
+ */
+VECTOR_EXTERN vector_try_expand_func_t vector_get_global_try_expand_func(void);
+
+/**
+ Set the library's try-expand function.
+
+ Before reallocating a vector's storage to grow it, the library calls this function to try to grow
+ the storage in place, which avoids copying the elements. The function must understand the blocks
+ allocated by the library's realloc() function.
+
+ @param try_expand_func A function that grows blocks in place, or @c NULL to always reallocate.
+ */
+VECTOR_EXTERN void vector_set_global_try_expand_func(const vector_try_expand_func_t try_expand_func);
+
+/**
+ The default library try-expand function.
+
+ With the GNU C library, this succeeds if the block's usable size, as reported by
+ malloc_usable_size(), already holds @c size bytes, so a vector grows into the slack the allocator
+ left at the end of its block without calling it. Elsewhere it always fails.
+ */
+VECTOR_EXTERN bool vector_default_global_try_expand_func(void *ptr, size_t size);
+
 #endif
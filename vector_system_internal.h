@@ -0,0 +1,81 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_SYSTEM_INTERNAL_H
+#define VECTOR_SYSTEM_INTERNAL_H
+
+/**
+ @file vector_system_internal.h
+
+ Calls through the library's system functions, used by the library's implementation (internal).
+
+ Each function fetches the current global function from vector_system.h and calls it, so the
+ library's modules interact with the system only through the functions the user has installed.
+ Code that makes several related calls, such as growing a buffer, should instead fetch one
+ consistent set with vector_get_global_hooks().
+ */
+
+#include "vector_system.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+static inline void vector_system_abort(void) {
+    vector_abort_func_t abort_func = vector_get_global_abort_func();
+    assert(abort_func);
+    abort_func();
+}
+
+static inline void vector_system_free(void *ptr) {
+    vector_free_func_t free_func = vector_get_global_free_func();
+    assert(free_func);
+    free_func(ptr);
+}
+
+static inline void *vector_system_memcpy(void *restrict dst, const void *restrict src, size_t n) {
+    vector_memcpy_func_t memcpy_func = vector_get_global_memcpy_func();
+    assert(memcpy_func);
+    return memcpy_func(dst, src, n);
+}
+
+static inline void *vector_system_memmove(void *dst, const void *src, size_t len) {
+    vector_memmove_func_t memmove_func = vector_get_global_memmove_func();
+    assert(memmove_func);
+    return memmove_func(dst, src, len);
+}
+
+static inline void *vector_system_realloc(void *ptr, const size_t size) {
+    vector_realloc_func_t realloc_func = vector_get_global_realloc_func();
+    assert(realloc_func);
+    return realloc_func(ptr, size);
+}
+
+static inline void vector_system_vfprintf(FILE * restrict stream, const char * restrict format, va_list args) {
+    vector_vfprintf_func_t vfprintf_func = vector_get_global_vfprintf_func();
+    if (vfprintf_func) {
+        vfprintf_func(stream, format, args);
+    }
+}
+
+static inline void vector_system_fprintf(FILE * restrict stream, const char * restrict format, ...) {
+    va_list arg_pointers;
+    va_start(arg_pointers, format);
+    vector_system_vfprintf(stream, format, arg_pointers);
+    va_end(arg_pointers);
+}
+
+#endif
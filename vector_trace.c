@@ -0,0 +1,114 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#include "vector_trace.h"
+#include "vector_atomic.h"
+#include "vector_check.h"
+#include "vector_system.h"
+
+// Each slot is a small sequence lock. Record number n is complete in slot n % VECTOR_TRACE_CAPACITY
+// when the slot's sequence is n + 1; a sequence of zero means the slot is being written.
+typedef struct slot_t {
+    size_t sequence;
+    const void *call_site;
+    size_t element_size;
+    size_t old_capacity;
+    size_t new_capacity;
+} slot_t;
+
+static slot_t ring[VECTOR_TRACE_CAPACITY];
+static size_t ring_head = 0;
+static size_t sample_period = 1;
+static VECTOR_THREAD_LOCAL size_t growths_since_sample = 0;
+
+static void trace_grow(const vector_t *vector, const void *call_site, size_t old_capacity, size_t new_capacity) {
+    if (++growths_since_sample < VECTOR_ATOMIC_LOAD_RELAXED(&sample_period)) {
+        return;
+    }
+    growths_since_sample = 0;
+
+    const size_t number = VECTOR_ATOMIC_FETCH_ADD(&ring_head, 1);
+    slot_t *slot = &ring[number % VECTOR_TRACE_CAPACITY];
+    VECTOR_ATOMIC_STORE_RELAXED(&slot->sequence, 0);
+    VECTOR_ATOMIC_FENCE_RELEASE();
+    VECTOR_ATOMIC_STORE_RELAXED(&slot->call_site, call_site);
+    VECTOR_ATOMIC_STORE_RELAXED(&slot->element_size, vector_element_size(vector));
+    VECTOR_ATOMIC_STORE_RELAXED(&slot->old_capacity, old_capacity);
+    VECTOR_ATOMIC_STORE_RELAXED(&slot->new_capacity, new_capacity);
+    VECTOR_ATOMIC_STORE_RELEASE(&slot->sequence, number + 1);
+}
+
+// Copy record number n, returning false if it has been overwritten or is being written.
+static bool read_record(const size_t number, vector_trace_record_t *record) {
+    slot_t *slot = &ring[number % VECTOR_TRACE_CAPACITY];
+    if (VECTOR_ATOMIC_LOAD_ACQUIRE(&slot->sequence) != number + 1) {
+        return false;
+    }
+    record->call_site = VECTOR_ATOMIC_LOAD_RELAXED(&slot->call_site);
+    record->element_size = VECTOR_ATOMIC_LOAD_RELAXED(&slot->element_size);
+    record->old_capacity = VECTOR_ATOMIC_LOAD_RELAXED(&slot->old_capacity);
+    record->new_capacity = VECTOR_ATOMIC_LOAD_RELAXED(&slot->new_capacity);
+    VECTOR_ATOMIC_FENCE_ACQUIRE();
+    return VECTOR_ATOMIC_LOAD_RELAXED(&slot->sequence) == number + 1;
+}
+
+// The number of the oldest record worth reading when at most max_records are wanted.
+static size_t first_record(const size_t head, const size_t max_records) {
+    const size_t count = max_records < VECTOR_TRACE_CAPACITY ? max_records : VECTOR_TRACE_CAPACITY;
+    return head > count ? head - count : 0;
+}
+
+void vector_trace_start(size_t period) {
+    VECTOR_CHECK(period >= 1);
+    for (size_t i = 0; i < VECTOR_TRACE_CAPACITY; ++i) {
+        VECTOR_ATOMIC_STORE_RELAXED(&ring[i].sequence, 0);
+    }
+    VECTOR_ATOMIC_STORE_RELAXED(&ring_head, 0);
+    VECTOR_ATOMIC_STORE_RELAXED(&sample_period, period > 0 ? period : 1);
+    growths_since_sample = 0;
+    vector_set_global_grow_func(trace_grow);
+}
+
+void vector_trace_stop(void) {
+    vector_set_global_grow_func(NULL);
+}
+
+size_t vector_trace_records(vector_trace_record_t *records, size_t max_records) {
+    VECTOR_CHECK(max_records == 0 || records);
+    const size_t head = VECTOR_ATOMIC_LOAD_ACQUIRE(&ring_head);
+    size_t count = 0;
+    for (size_t number = first_record(head, max_records); number < head; ++number) {
+        if (read_record(number, &records[count])) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t vector_trace_dump(FILE *stream) {
+    VECTOR_CHECK(stream);
+    const size_t head = VECTOR_ATOMIC_LOAD_ACQUIRE(&ring_head);
+    size_t count = 0;
+    for (size_t number = first_record(head, VECTOR_TRACE_CAPACITY); number < head; ++number) {
+        vector_trace_record_t record;
+        if (read_record(number, &record)) {
+            fprintf(stream, "%p %zu %zu %zu\n", record.call_site, record.element_size, record.old_capacity,
+                    record.new_capacity);
+            ++count;
+        }
+    }
+    return count;
+}
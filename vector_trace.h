@@ -0,0 +1,88 @@
+/*
+ Copyright 2016-present Adrian Secord. All Rights Reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+ http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#ifndef VECTOR_TRACE_H
+#define VECTOR_TRACE_H
+
+/**
+ @file vector_trace.h
+
+ Sampled tracing of vector growth (optional).
+
+ Tracing installs a grow function (see vector_set_global_grow_func()) that records one in every N
+ reallocations on each thread into a fixed-size, lock-free ring buffer. Each record holds the
+ address of the code that caused the growth, the element size and the old and new capacities, so
+ the code paths that reallocate the most can be found in a running program at a small cost.
+
+ Call sites are return addresses into the program; tools such as addr2line(1) map them back to
+ source lines. When the ring buffer is full, new records overwrite the oldest ones.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "vector_environment.h"
+
+/** The number of records kept by the ring buffer. */
+#define VECTOR_TRACE_CAPACITY 4096
+
+/** One sampled growth of a vector's storage. */
+typedef struct vector_trace_record_t {
+    const void *call_site;      /**< Return address of the library function that grew the vector. */
+    size_t element_size;        /**< The vector's element size in bytes. */
+    size_t old_capacity;        /**< The capacity before growing, in elements. */
+    size_t new_capacity;        /**< The capacity after growing, in elements. */
+} vector_trace_record_t;
+
+/**
+ Start tracing vector growth, replacing the library's grow function.
+
+ Discards any records from earlier tracing, so should not be called while another thread is
+ tracing.
+
+ @param sample_period Record one in every @p sample_period growths on each thread. Must be at least 1.
+ */
+VECTOR_EXTERN void vector_trace_start(size_t sample_period);
+
+/**
+ Stop tracing vector growth and remove the library's grow function.
+
+ The records are kept until tracing is started again.
+ */
+VECTOR_EXTERN void vector_trace_stop(void);
+
+/**
+ Copy the most recent records, oldest first.
+
+ Records being written by other threads during the copy are skipped.
+
+ @param records     Space for at least @p max_records records.
+ @param max_records The maximum number of records to copy.
+ @return The number of records copied.
+ */
+VECTOR_EXTERN size_t vector_trace_records(vector_trace_record_t *records, size_t max_records);
+
+/**
+ Write the records to a stream, oldest first, one per line.
+
+ Each line holds the call site, element size, old capacity and new capacity separated by spaces.
+
+ @param stream The stream to write to.
+ @return The number of records written.
+ */
+VECTOR_EXTERN size_t vector_trace_dump(FILE *stream);
+
+#endif